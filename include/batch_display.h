@@ -0,0 +1,21 @@
+#ifndef BATCH_DISPLAY_H
+#define BATCH_DISPLAY_H
+
+#include <vector>
+
+#include "network.h"
+#include "process.h"
+#include "storage.h"
+#include "system.h"
+
+/*
+Plain text output on stdout, one block per tick, for logging and scripts
+*/
+namespace BatchDisplay {
+void Display(System& system, int ticks, int n = 15);
+void DisplayNetwork(Network& network);
+void DisplayDisks(Storage& storage);
+void DisplayProcesses(std::vector<Process>& processes, int n, Network* network);
+};  // namespace BatchDisplay
+
+#endif
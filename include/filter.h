@@ -0,0 +1,50 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <string>
+#include <vector>
+
+#include "process.h"
+
+/*
+Process filter compiled from an expression such as "user=build cpu>5 cmd~java"
+
+Every term must hold for a process to match. The terms are grouped into
+stages ordered by the cost of the data they need, so that the scanner can
+reject a process before reading its more expensive files:
+  kIdentity  pid                (no file is opened)
+  kStatus    uid, user, ram     (/proc/[PID]/status)
+  kStat      ppid, state, cpu, time  (/proc/[PID]/stat, read every tick)
+  kDetail    cmd                (/proc/[PID]/cmdline, cached per process)
+kStatus comes before kStat so that a process rejected on its user never
+has its stat file read. uid and user compare the real user ID from status,
+the one the USER column shows, not the owner of /proc/[PID], which is the
+effective user ID and root for setuid and non-dumpable processes.
+*/
+class Filter {
+ public:
+  enum Stage { kIdentity = 0, kStatus, kStat, kDetail };
+
+  bool Compile(std::string const& expression);
+  bool Empty() const;
+  std::string const& Expression() const;
+  bool Matches(Process& process, Stage stage) const;
+
+ private:
+  enum Field { kPid, kPpid, kUid, kState, kCpu, kTime, kRam, kCommand };
+  enum Op { kEqual, kNotEqual, kLess, kLessEqual, kGreater, kGreaterEqual,
+            kContains };
+  struct Term {
+    Field field;
+    Op op;
+    Stage stage;
+    double number;
+    std::string text;
+  };
+  static bool Compare(double value, Op op, double number);
+
+  std::string expression_ = {};
+  std::vector<Term> terms_ = {};
+};
+
+#endif
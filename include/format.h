@@ -1,10 +1,12 @@
 #ifndef FORMAT_H
 #define FORMAT_H
 
+#include <cstddef>
 #include <string>
 
 namespace Format {
 std::string ElapsedTime(long times);  // TODO: See src/format.cpp
+char const* ElapsedTime(long times, char* buffer, size_t size);
 };                                    // namespace Format
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,28 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include <array>
+#include <cstddef>
+
+/*
+The last kSize samples of one metric, oldest overwritten first
+
+The samples live in a fixed array inside the object, so recording a
+sample never allocates.
+*/
+class History {
+ public:
+  static constexpr size_t kSize{60};
+
+  void Add(float sample);
+  size_t Size() const;
+  float operator[](size_t age) const;  // 0 is the latest sample
+  float Max() const;
+
+ private:
+  std::array<float, kSize> samples_{};
+  size_t next_{0};
+  size_t size_{0};
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+#include <chrono>
+#include <cstddef>
+
+/*
+Self-instrumentation of the monitor: time spent per stage of a tick and
+counts of syscalls, files opened, bytes read and heap allocations.
+
+Every thread updates its own slot of relaxed atomics, so recording never
+takes a lock; Collect() sums the slots. Totals only grow, the cost of one
+tick is the difference of two Collect() calls.
+
+Stages are exclusive: a timer started while another one runs on the same
+thread pauses the outer one, so the stages of a tick add up to its total.
+*/
+namespace Instrument {
+enum Stage { kPids = 0, kParse, kUser, kSort, kSystem, kDraw, kStageCount };
+enum Counter {
+  kSyscalls = 0,
+  kFilesOpened,
+  kBytesRead,
+  kAllocations,
+  kEstimatedSyscalls,  // reads of buffered streams, which are not seen
+  kCounterCount
+};
+
+struct Totals {
+  long nanoseconds[kStageCount]{};
+  long counters[kCounterCount]{};
+  Totals operator-(Totals const& a) const;
+};
+
+void Add(Stage stage, long nanoseconds);
+void Count(Counter counter, long n = 1);
+Totals Collect();
+char const* Summary(Totals const& totals, char* buffer, size_t size);
+
+// an open(2) or opendir(3) and its matching close
+inline void FileOpened() {
+  Count(kFilesOpened);
+  Count(kSyscalls, 2);
+}
+
+// one read(2) returning bytes
+inline void BytesRead(long bytes) {
+  Count(kSyscalls);
+  if (bytes > 0) {
+    Count(kBytesRead, bytes);
+  }
+}
+
+// an ifstream or a directory stream: its open and close, and an estimate
+// of one buffered read or getdents, since the stream hides how many it
+// made; the bytes of a stream are counted per line
+inline void StreamOpened() {
+  Count(kFilesOpened);
+  Count(kSyscalls, 2);
+  Count(kEstimatedSyscalls);
+}
+
+// Adds the lifetime of the timer to a stage, minus the time of the timers
+// nested in it
+class ScopedTimer {
+ public:
+  explicit ScopedTimer(Stage stage)
+      : stage_(stage), outer_(active_) {
+    auto now = std::chrono::steady_clock::now();
+    if (outer_ != nullptr) {
+      outer_->Stop(now);
+    }
+    start_ = now;
+    active_ = this;
+  }
+  ~ScopedTimer() {
+    auto now = std::chrono::steady_clock::now();
+    Stop(now);
+    active_ = outer_;
+    if (outer_ != nullptr) {
+      outer_->start_ = now;
+    }
+  }
+
+ private:
+  void Stop(std::chrono::steady_clock::time_point now) {
+    Add(stage_,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - start_)
+            .count());
+  }
+
+  Stage stage_;
+  ScopedTimer* outer_;
+  std::chrono::steady_clock::time_point start_;
+  static inline thread_local ScopedTimer* active_{nullptr};
+};
+};  // namespace Instrument
+
+#endif
@@ -4,11 +4,14 @@
 #include <fstream>
 #include <regex>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace LinuxParser {
 // Paths
 const std::string kProcDirectory{"/proc/"};
 const std::string kCmdlineFilename{"/cmdline"};
+const std::string kCommFilename{"/comm"};
 const std::string kCpuinfoFilename{"/cpuinfo"};
 const std::string kStatusFilename{"/status"};
 const std::string kStatFilename{"/stat"};
@@ -17,6 +20,15 @@ const std::string kMeminfoFilename{"/meminfo"};
 const std::string kVersionFilename{"/version"};
 const std::string kOSPath{"/etc/os-release"};
 const std::string kPasswordPath{"/etc/passwd"};
+const std::string kTaskDirectory{"/task/"};
+const std::string kNodeDirectory{"/sys/devices/system/node/"};
+const std::string kCpulistFilename{"/cpulist"};
+const std::string kNetDevFilename{"/net/dev"};
+const std::string kTcpFilename{"/net/tcp"};
+const std::string kTcp6Filename{"/net/tcp6"};
+const std::string kFdDirectory{"/fd/"};
+const std::string kDiskStatsFilename{"/diskstats"};
+const std::string kBlockDirectory{"/sys/class/block/"};
 
 // filter words in files
 const std::string filterProcesses("processes");
@@ -30,11 +42,12 @@ const std::string filterProcMem("VmData:");
 // System
 float MemoryUtilization();
 long UpTime();
-std::vector<int> Pids();
+void Pids(std::vector<int>& pids);
 int TotalProcesses();
 int RunningProcesses();
 std::string OperatingSystem();
 std::string Kernel();
+std::vector<int> CpuNodes();
 
 // CPU
 enum CPUStates {
@@ -50,17 +63,75 @@ enum CPUStates {
   kGuestNice_
 };
 std::vector<std::string> CpuUtilization();
+bool CpuJiffies(long (&jiffies)[kGuestNice_ + 1]);
 long Jiffies();
 long ActiveJiffies();
 long ActiveJiffies(int pid);
 long IdleJiffies();
 
+// Fields of a /proc/[PID]/stat or /proc/[PID]/task/[TID]/stat line
+struct Stat {
+  char name[16]{};  // comm, the executable name truncated by the kernel
+  char state{'?'};
+  int ppid{0};
+  long utime{0};
+  long stime{0};
+  long cutime{0};
+  long cstime{0};
+  long starttime{0};
+  int processor{-1};
+};
+bool ParseStat(char const* filename, Stat& stat);
+bool ParseStat(int pid, Stat& stat);
+bool ParseStat(int pid, int tid, Stat& stat);
+
+// Fields of a /proc/[PID]/status file
+struct Status {
+  long uid{-1};
+  long vm_data{0};  // kB
+};
+bool ParseStatus(int pid, Status& status);
+
 // Processes
-std::string Command(int pid);
-std::string Ram(int pid);
+size_t Command(int pid, char* buffer, size_t size);
 std::string Uid(int pid);
 std::string User(int pid);
+std::string UserName(long uid);
 long int UpTime(int pid);
+
+// Threads
+void Tids(int pid, std::vector<int>& tids);
+
+// Network
+// Counters of one line of /proc/net/dev
+struct NetDevice {
+  char name[16]{};
+  long rx_bytes{0};
+  long rx_packets{0};
+  long rx_drop{0};
+  long tx_bytes{0};
+  long tx_packets{0};
+  long tx_drop{0};
+};
+void NetDevices(std::vector<NetDevice>& devices);
+void TcpInodes(std::vector<unsigned long>& inodes);
+void SocketInodes(int pid, std::vector<unsigned long>& inodes);
+
+// Disks
+// Counters of one line of /proc/diskstats, times in milliseconds
+struct DiskStat {
+  char name[32]{};
+  long reads{0};
+  long read_sectors{0};  // 512 bytes each
+  long read_time{0};
+  long writes{0};
+  long write_sectors{0};
+  long write_time{0};
+  long io_time{0};  // time the device had requests in flight
+};
+void DiskStats(std::vector<DiskStat>& disks);
+enum DiskKinds { kVirtualDisk_ = 0, kDisk_, kPartition_ };
+DiskKinds DiskKind(char const* name);
 };  // namespace LinuxParser
 
 #endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "instrument.h"
+#include "system.h"
+
+/*
+Exports the sampled metrics in the Prometheus text exposition format
+
+The sampler (Run, on the calling thread, until SIGINT or SIGTERM) walks
+/proc once per second and publishes an immutable Snapshot. The server
+thread answers every scrape from the latest snapshot, so a scrape never
+touches /proc, and renders the response into a buffer that is reused
+between scrapes.
+
+The address is either a TCP port on localhost ("9101"), host:port
+("127.0.0.1:9101") or the path of a Unix socket ("/run/monitor.sock").
+*/
+class MetricsServer {
+ public:
+  MetricsServer(std::string const& address, int top_k);
+  ~MetricsServer();
+  bool Start();
+  void Run(System& system);
+
+ private:
+  struct ProcessSample {
+    int pid;
+    std::string user;
+    std::string name;
+    float cpu;
+    long ram_kb;
+    long uptime;
+  };
+  struct Snapshot {
+    long timestamp_ms{0};
+    float cpu{0};
+    float memory{0};
+    long uptime{0};
+    int total_processes{0};
+    int running_processes{0};
+    std::vector<ProcessSample> processes = {};
+    Instrument::Totals costs = {};
+  };
+
+  std::shared_ptr<Snapshot> Sample(System& system);
+  void Publish(std::shared_ptr<Snapshot const> snapshot);
+  std::shared_ptr<Snapshot const> Latest();
+  void Serve();
+  void Render(Snapshot const& snapshot);
+
+  std::string address_;
+  int top_k_;
+  int listen_fd_{-1};
+  // whether a Unix socket file was created, and so is removed on exit
+  bool bound_socket_file_{false};
+  std::mutex mutex_;
+  std::shared_ptr<Snapshot const> latest_ = {};
+  std::shared_ptr<Snapshot> spare_ = {};
+  std::thread server_ = {};
+  std::string body_ = {};
+  std::string response_ = {};
+};
+
+#endif
@@ -3,14 +3,46 @@
 
 #include <curses.h>
 
+#include "history.h"
+#include "network.h"
 #include "process.h"
+#include "storage.h"
 #include "system.h"
 
 namespace NCursesDisplay {
+// rows of the process table kept however small the terminal is
+constexpr int kMinProcessRows{5};
+
+// The windows of the screen and the rows of their tables; the network and
+// disk windows are null when the terminal has no rows left for them
+struct Layout {
+  WINDOW* system{nullptr};
+  WINDOW* network{nullptr};
+  WINDOW* disks{nullptr};
+  WINDOW* processes{nullptr};
+  int network_rows{0};
+  int disk_rows{0};
+  int process_rows{0};
+};
+
 void Display(System& system, int n =15);
 void DisplaySystem(System& system, WINDOW* window);
-void DisplayProcesses(std::vector<Process>& processes, WINDOW* window, int n);
-std::string ProgressBar(float percent);
+void DisplayNetwork(Network& network, WINDOW* window, int rows);
+void DisplayDisks(Storage& storage, WINDOW* window, int rows);
+int DisplayProcesses(std::vector<Process>& processes, WINDOW* window, int n,
+                     int selected_pid, Network* network);
+int DisplayProcessWindow(System& system, std::vector<Process>& processes,
+                         WINDOW* window, int n, int selected_pid,
+                         char const* footer);
+int DisplayThreads(Process& process, WINDOW* window, int row, int last_row);
+void PromptFilter(System& system, WINDOW* window);
+bool HandleKey(int key, std::vector<Process>& processes, int& selected_pid,
+               int drawn);
+int PanelRows(int wanted, int& free_rows);
+Layout CreateLayout(System& system, int n);
+void DeleteLayout(Layout& layout);
+void ProgressBar(float percent, WINDOW* window);
+void Sparkline(History const& history, float max, int width, WINDOW* window);
 };  // namespace NCursesDisplay
 
 #endif
\ No newline at end of file
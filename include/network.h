@@ -0,0 +1,47 @@
+#ifndef NETWORK_H
+#define NETWORK_H
+
+#include <vector>
+
+#include "linux_parser.h"
+#include "rates.h"
+
+/*
+Network interface throughput and per-process TCP socket counts
+
+The TCP socket inodes of the system are read once per UpdateSockets(), and
+a process's file descriptors are only looked at when TcpSockets() is asked
+for it.
+*/
+class Network {
+ public:
+  struct Interface {
+    LinuxParser::NetDevice counters;
+    float rx_bytes_rate{0};
+    float tx_bytes_rate{0};
+    float rx_packets_rate{0};
+    float tx_packets_rate{0};
+    float rx_drop_rate{0};
+    float tx_drop_rate{0};
+  };
+
+  void Update();
+  std::vector<Interface>& Interfaces();
+  void UpdateSockets();
+  int TcpSockets(int pid);
+
+ private:
+  bool IsTcpSocket(unsigned long inode) const;
+
+  // the lines of /proc/net/dev as of the last Update() and the one
+  // before it, swapped instead of copied
+  std::vector<LinuxParser::NetDevice> devices_ = {};
+  std::vector<LinuxParser::NetDevice> read_ = {};
+  std::vector<Interface> interfaces_ = {};
+  Rates::Interval interval_ = {};
+  // inodes of all TCP sockets, an open addressing hash set (0 is empty)
+  std::vector<unsigned long> tcp_inodes_ = {};
+  std::vector<unsigned long> inodes_ = {};
+};
+
+#endif
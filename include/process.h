@@ -1,28 +1,87 @@
 #ifndef PROCESS_H
 #define PROCESS_H
 
-#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
 #include "linux_parser.h"
+#include "network.h"
+#include "string_table.h"
+#include "thread.h"
 
 /*
 Basic class for Process representation
+
+Numbers are stored as numbers and formatted only when drawn. The user name
+and the command line are handles into a string table shared by all
+processes, so sampling and drawing a process does not allocate.
 */
 class Process {
  public:
   void setPid(int pid);
-  int Pid();                               
-  std::string User();                   
-  std::string Command();                   
-  float CpuUtilization();                 
-  std::string Ram();                      
-  long int UpTime();                       
+  int Pid();
+  int Ppid();
+  char State();
+  long Uid();
+  std::string_view User();
+  std::string_view Command();
+  std::string_view Name();
+  float CpuUtilization();
+  long Ram();
+  long RamKb();
+  int TcpSockets(Network& network);
+  long int UpTime();
+  void Expire();
+  void Update(long uptime);
+  void ReleaseStrings();
+  static constexpr size_t kMaxCommandLength{4096};
+  static void setCommandLength(size_t length);
+  static void CompactStrings(std::vector<Process>& processes);
+  bool Visible();
+  void setVisible(bool visible);
   bool operator<(Process const& a) const;
 
+  // Threads, only collected for expanded processes and the top-K by CPU
+  bool Expanded();
+  void setExpanded(bool expanded);
+  void UpdateThreads(long uptime, std::vector<int> const& cpu_nodes);
+  void ClearThreads();
+  std::vector<Thread>& Threads();
+  int CoresUsed();
+  std::vector<int>& NodeThreads();
+
  private:
+    void ReadStatus();
+
     int pid_;
     long prev_active_{0};
     long prev_uptime_{0};
+    long uptime_{0};
+    long starttime_{0};
+    int ppid_{0};
+    char state_{'?'};
+    char name_[16]{};
     float cpu_utilization_{0.0};
+    bool visible_{true};
+    // from /proc/[PID]/status, read at most once per tick
+    long uid_{-1};
+    long ram_kb_{0};
+    bool status_read_{false};
+    // open TCP sockets, counted at most once per tick
+    int tcp_sockets_{0};
+    bool sockets_read_{false};
+    // command line, read once per PID lifetime (PID + starttime)
+    StringTable::Handle command_ = {};
+    bool command_read_{false};
+    bool expanded_{false};
+    std::vector<Thread> threads_ = {};
+    int cores_used_{0};
+    std::vector<int> node_threads_ = {};
+
+    static size_t command_length_;
+    static StringTable strings_;
+    static std::unordered_map<long, StringTable::Handle> users_;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,17 +1,20 @@
 #ifndef PROCESSOR_H
 #define PROCESSOR_H
 
+#include "history.h"
 #include "linux_parser.h"
 #include <string>
 
 class Processor {
  public:
   float Utilization();  // TODO: See src/processor.cpp
+  History const& UtilizationHistory() const;
 
   // TODO: Declare any necessary private members
  private:
  long prev_active_{0};
  long prev_total_{0};
+ History history_ = {};
 };
 
 #endif
\ No newline at end of file
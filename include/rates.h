@@ -0,0 +1,46 @@
+#ifndef RATES_H
+#define RATES_H
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+/*
+Rates of the cumulative counters of /proc files such as /proc/net/dev and
+/proc/diskstats, calculated between two reads
+
+The users of these helpers keep the current read, the last read and the
+rates in vectors between ticks and swap the two reads instead of copying
+them, so that once the devices of the system are known, updating does not
+allocate.
+*/
+namespace Rates {
+long Delta(long current, long previous);
+float Rate(long current, long previous, float seconds);
+
+// The time between two calls of Seconds()
+class Interval {
+ public:
+  float Seconds();
+
+ private:
+  std::chrono::steady_clock::time_point last_ = {};
+};
+
+// Return whether two reads list the same devices in the same order, so
+// that their counters can be paired up by index
+template <typename T>
+bool SameNames(std::vector<T> const& a, std::vector<T> const& b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (strcmp(a[i].name, b[i].name) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+};  // namespace Rates
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <vector>
+
+#include "history.h"
+#include "linux_parser.h"
+#include "rates.h"
+
+/*
+Throughput, IOPS, latency and utilization of the system's block devices
+
+Only disks are kept, not loop or RAM disks, and partitions only when
+asked for. The utilization is recorded in a fixed size history like the
+CPU's.
+*/
+class Storage {
+ public:
+  struct Disk {
+    LinuxParser::DiskStat counters;
+    size_t index{0};  // position in /proc/diskstats
+    float read_rate{0};   // bytes per second
+    float write_rate{0};  // bytes per second
+    float iops{0};
+    float await{0};        // average milliseconds per I/O
+    float utilization{0};  // share of the time with I/O in flight
+    History utilization_history = {};
+  };
+
+  void Update();
+  std::vector<Disk>& Disks();
+  void setPartitions(bool partitions);
+
+ private:
+  void Rebuild();
+
+  bool partitions_{false};
+  // the lines of /proc/diskstats as of the last Update() and the one
+  // before it, swapped instead of copied
+  std::vector<LinuxParser::DiskStat> stats_ = {};
+  std::vector<LinuxParser::DiskStat> read_ = {};
+  std::vector<Disk> disks_ = {};
+  Rates::Interval interval_ = {};
+};
+
+#endif
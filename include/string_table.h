@@ -0,0 +1,48 @@
+#ifndef STRING_TABLE_H
+#define STRING_TABLE_H
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/*
+Interned strings stored back to back in a bump arena
+
+Equal strings share one copy, identified by a small Handle instead of a
+std::string. Handles are reference counted: the bytes of a released string
+become garbage that is only reclaimed by copying the live strings into a
+fresh table (see Process::CompactStrings). Interning a string that is
+already present, and reading one back, never allocates.
+*/
+class StringTable {
+ public:
+  struct Handle {
+    uint32_t block{0};
+    uint32_t offset{0};
+    uint32_t length{0};
+  };
+
+  Handle Intern(std::string_view text);
+  void Release(Handle handle);
+  std::string_view Get(Handle handle) const;
+  size_t LiveBytes() const;
+  size_t GarbageBytes() const;
+
+  static constexpr size_t kBlockSize{64 * 1024};
+
+ private:
+  struct Entry {
+    Handle handle;
+    int references;
+  };
+
+  std::vector<std::unique_ptr<char[]>> blocks_ = {};
+  size_t used_{kBlockSize};  // bytes used in the last block
+  size_t live_{0};
+  size_t garbage_{0};
+  std::unordered_map<std::string_view, Entry> entries_ = {};
+};
+
+#endif
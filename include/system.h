@@ -4,26 +4,48 @@
 #include <string>
 #include <vector>
 
+#include "filter.h"
+#include "network.h"
 #include "process.h"
 #include "processor.h"
+#include "storage.h"
 
 #include "linux_parser.h"
 
 class System {
  public:
   Processor& Cpu();                   // TODO: See src/system.cpp
+  Network& Net();
+  Storage& Disks();
   std::vector<Process>& Processes();  // TODO: See src/system.cpp
   float MemoryUtilization();          // TODO: See src/system.cpp
   long UpTime();                      // TODO: See src/system.cpp
   int TotalProcesses();               // TODO: See src/system.cpp
   int RunningProcesses();             // TODO: See src/system.cpp
-  std::string Kernel();               // TODO: See src/system.cpp
-  std::string OperatingSystem();      // TODO: See src/system.cpp
+  std::string const& Kernel();        // TODO: See src/system.cpp
+  std::string const& OperatingSystem();  // TODO: See src/system.cpp
+  void setThreadTopK(int k);
+  bool setFilter(std::string const& expression);
+  Filter const& ProcessFilter();
+  void setSockets(bool sockets);
+  bool Sockets();
 
   // TODO: Define any necessary private members
  private:
   Processor cpu_ = {};
+  Network network_ = {};
+  Storage storage_ = {};
+  bool sockets_{false};
   std::vector<Process> processes_ = {};
+  std::vector<int> cpu_nodes_ = LinuxParser::CpuNodes();
+  int thread_top_k_{0};
+  Filter filter_ = {};
+  std::string kernel_ = LinuxParser::Kernel();
+  std::string operating_system_ = LinuxParser::OperatingSystem();
+  std::vector<int> old_pids_ = {};
+  std::vector<int> new_pids_ = {};
+  std::vector<int> added_pids_ = {};
+  std::vector<int> deleted_pids_ = {};
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,29 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+#include "linux_parser.h"
+
+/*
+Basic class for the representation of one thread (task) of a process
+*/
+class Thread {
+ public:
+  void setTid(int pid, int tid);
+  int Tid() const;
+  char State() const;
+  int Processor() const;
+  float CpuUtilization() const;
+  void Update(long uptime);
+  bool operator<(Thread const& a) const;
+
+ private:
+  int pid_;
+  int tid_;
+  char state_{'?'};
+  int processor_{-1};
+  long prev_active_{0};
+  long prev_uptime_{0};
+  float cpu_utilization_{0.0};
+};
+
+#endif
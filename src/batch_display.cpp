@@ -0,0 +1,89 @@
+#include <chrono>
+#include <cstdio>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "batch_display.h"
+#include "format.h"
+#include "instrument.h"
+
+// Print the throughput of every network interface
+void BatchDisplay::DisplayNetwork(Network& network) {
+  network.Update();
+  for (auto& interface : network.Interfaces()) {
+    printf("%s: rx %.1f KB/s %.0f pkt/s %.0f drops/s, "
+           "tx %.1f KB/s %.0f pkt/s %.0f drops/s\n",
+           interface.counters.name, interface.rx_bytes_rate / 1024,
+           interface.rx_packets_rate, interface.rx_drop_rate,
+           interface.tx_bytes_rate / 1024, interface.tx_packets_rate,
+           interface.tx_drop_rate);
+  }
+}
+
+// Print the throughput, IOPS, latency and utilization of every disk
+void BatchDisplay::DisplayDisks(Storage& storage) {
+  storage.Update();
+  for (auto& disk : storage.Disks()) {
+    printf("%s: read %.1f KB/s, write %.1f KB/s, %.0f IOPS, await %.1f ms, "
+           "util %.1f%%\n",
+           disk.counters.name, disk.read_rate / 1024, disk.write_rate / 1024,
+           disk.iops, disk.await, disk.utilization * 100);
+  }
+}
+
+// Print the n busiest visible processes
+// With a network, a SOCK column shows the TCP sockets of every process
+void BatchDisplay::DisplayProcesses(std::vector<Process>& processes, int n,
+                                    Network* network) {
+  char time[32];
+  printf("%7s %-8s %6s %8s %9s %s %s\n", "PID", "USER", "CPU[%]", "RAM[MB]",
+         "TIME+", network != nullptr ? " SOCK" : "", "COMMAND");
+  for (size_t i = 0;
+       i < processes.size() && processes[i].Visible() && i < size_t(n); ++i) {
+    std::string_view user = processes[i].User();
+    std::string_view command = processes[i].Command();
+    printf("%7d %-8.*s %6.1f %8ld %9s ", processes[i].Pid(),
+           static_cast<int>(user.size()), user.data(),
+           processes[i].CpuUtilization() * 100, processes[i].Ram(),
+           Format::ElapsedTime(processes[i].UpTime(), time, sizeof(time)));
+    if (network != nullptr) {
+      printf("%5d ", processes[i].TcpSockets(*network));
+    }
+    printf("%.*s\n", static_cast<int>(command.size()), command.data());
+  }
+}
+
+// Print ticks snapshots one second apart, each followed by the cost of
+// producing it; ticks <= 0 runs until interrupted
+void BatchDisplay::Display(System& system, int ticks, int n) {
+  Instrument::Totals last_totals = Instrument::Collect();
+  char time[32];
+  char costs[256];
+  for (int tick = 0; ticks <= 0 || tick < ticks; ++tick) {
+    {
+      Instrument::ScopedTimer timer(Instrument::kSystem);
+      printf("up %s, cpu %.1f%%, memory %.1f%%, %d processes, %d running\n",
+             Format::ElapsedTime(system.UpTime(), time, sizeof(time)),
+             system.Cpu().Utilization() * 100,
+             system.MemoryUtilization() * 100, system.TotalProcesses(),
+             system.RunningProcesses());
+      DisplayNetwork(system.Net());
+      DisplayDisks(system.Disks());
+    }
+    std::vector<Process>& processes = system.Processes();
+    {
+      Instrument::ScopedTimer timer(Instrument::kDraw);
+      DisplayProcesses(processes, n,
+                       system.Sockets() ? &system.Net() : nullptr);
+    }
+    Instrument::Totals totals = Instrument::Collect();
+    printf("cost: %s\n\n",
+           Instrument::Summary(totals - last_totals, costs, sizeof(costs)));
+    fflush(stdout);
+    last_totals = totals;
+    if (ticks <= 0 || tick + 1 < ticks) {
+      std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+  }
+}
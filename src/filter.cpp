@@ -0,0 +1,188 @@
+#include <pwd.h>
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "filter.h"
+#include "linux_parser.h"
+
+using std::string;
+using std::vector;
+
+/*  Compile a filter expression into a list of terms.
+
+    Terms are separated by whitespace and have the form <field><op><value>
+    with op one of = != < <= > >= ~ (substring). User names are resolved
+    to a uid here, once, instead of for every process.
+    Returns false, leaving the previous filter in place, on a syntax error.
+    An empty expression clears the filter.
+*/
+bool Filter::Compile(string const& expression) {
+  vector<Term> terms;
+  std::istringstream stream(expression);
+  string token;
+  while (stream >> token) {
+    size_t op_start = token.find_first_of("=!<>~");
+    if (op_start == string::npos || op_start == 0) {
+      return false;
+    }
+    string name = token.substr(0, op_start);
+    size_t op_end = op_start + 1;
+    if (op_end < token.size() && token[op_end] == '=' &&
+        token[op_start] != '=' && token[op_start] != '~') {
+      ++op_end;
+    }
+    string op = token.substr(op_start, op_end - op_start);
+    string value = token.substr(op_end);
+    if (value.empty()) {
+      return false;
+    }
+
+    Term term;
+    if (op == "=") term.op = kEqual;
+    else if (op == "!=") term.op = kNotEqual;
+    else if (op == "<") term.op = kLess;
+    else if (op == "<=") term.op = kLessEqual;
+    else if (op == ">") term.op = kGreater;
+    else if (op == ">=") term.op = kGreaterEqual;
+    else if (op == "~") term.op = kContains;
+    else return false;
+
+    bool numeric{true};
+    if (name == "pid") {
+      term.field = kPid;
+      term.stage = kIdentity;
+    } else if (name == "uid") {
+      term.field = kUid;
+      term.stage = kStatus;
+    } else if (name == "user") {
+      // compile the user name to a uid compare
+      struct passwd* entry = getpwnam(value.c_str());
+      if (entry == nullptr) {
+        return false;
+      }
+      term.field = kUid;
+      term.stage = kStatus;
+      value = std::to_string(entry->pw_uid);
+    } else if (name == "ppid") {
+      term.field = kPpid;
+      term.stage = kStat;
+    } else if (name == "state") {
+      term.field = kState;
+      term.stage = kStat;
+      numeric = false;
+    } else if (name == "cpu") {
+      term.field = kCpu;
+      term.stage = kStat;
+    } else if (name == "time") {
+      term.field = kTime;
+      term.stage = kStat;
+    } else if (name == "ram") {
+      term.field = kRam;
+      term.stage = kStatus;
+    } else if (name == "cmd") {
+      term.field = kCommand;
+      term.stage = kDetail;
+      numeric = false;
+    } else {
+      return false;
+    }
+
+    if (numeric) {
+      char* end;
+      term.number = strtod(value.c_str(), &end);
+      if (*end != '\0' || term.op == kContains) {
+        return false;
+      }
+    } else {
+      if (term.op != kEqual && term.op != kNotEqual && term.op != kContains) {
+        return false;
+      }
+      if (term.field == kState && (value.size() != 1 || term.op == kContains)) {
+        return false;
+      }
+      term.text = value;
+    }
+    terms.emplace_back(term);
+  }
+
+  // cheapest stage first
+  std::stable_sort(terms.begin(), terms.end(),
+                   [](Term const& a, Term const& b) { return a.stage < b.stage; });
+  terms_ = std::move(terms);
+  expression_ = expression;
+  return true;
+}
+
+// Return whether no terms are set, so every process matches
+bool Filter::Empty() const { return terms_.empty(); }
+
+// Return the expression the filter was compiled from
+string const& Filter::Expression() const { return expression_; }
+
+// Evaluate the terms of one stage against a process
+// The data of that stage is read only if a term needs it
+bool Filter::Matches(Process& process, Stage stage) const {
+  for (auto const& term : terms_) {
+    if (term.stage != stage) {
+      continue;
+    }
+    switch (term.field) {
+      case kPid:
+        if (!Compare(process.Pid(), term.op, term.number)) return false;
+        break;
+      case kUid:
+        if (!Compare(process.Uid(), term.op, term.number)) return false;
+        break;
+      case kPpid:
+        if (!Compare(process.Ppid(), term.op, term.number)) return false;
+        break;
+      case kState:
+        if ((process.State() == term.text[0]) != (term.op == kEqual)) {
+          return false;
+        }
+        break;
+      case kCpu:
+        if (!Compare(process.CpuUtilization() * 100, term.op, term.number)) {
+          return false;
+        }
+        break;
+      case kTime:
+        if (!Compare(process.UpTime(), term.op, term.number)) return false;
+        break;
+      case kRam:
+        if (!Compare(process.Ram(), term.op, term.number)) {
+          return false;
+        }
+        break;
+      case kCommand: {
+        std::string_view command = process.Command();
+        bool found = term.op == kContains
+                         ? command.find(term.text) != std::string_view::npos
+                         : command == term.text;
+        if (found == (term.op == kNotEqual)) {
+          return false;
+        }
+        break;
+      }
+    }
+  }
+  return true;
+}
+
+// Apply a numeric comparison operator
+bool Filter::Compare(double value, Op op, double number) {
+  switch (op) {
+    case kEqual: return value == number;
+    case kNotEqual: return value != number;
+    case kLess: return value < number;
+    case kLessEqual: return value <= number;
+    case kGreater: return value > number;
+    case kGreaterEqual: return value >= number;
+    case kContains: return false;
+  }
+  return false;
+}
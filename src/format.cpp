@@ -1,4 +1,6 @@
 //#include <string>
+#include <cstdio>
+
 #include "format.h"
 
 using std::string;
@@ -7,23 +9,18 @@ using std::string;
 // INPUT: Long int measuring seconds
 // OUTPUT: HH:MM:SS
 string Format::ElapsedTime(long seconds) { 
-    string time = "";
-    int hrs = seconds / 3600;
+    char buffer[32];
+    return ElapsedTime(seconds, buffer, sizeof(buffer));
+}
+
+// Same as above, written into a caller's buffer so that drawing a row
+// does not allocate
+char const* Format::ElapsedTime(long seconds, char* buffer, size_t size) {
+    long hrs = seconds / 3600;
     int mins = (seconds % 3600) / 60;
     int secs = (seconds % 3600) % 60;
 
     // format return string as HH:MM:SS
-    if (hrs < 10) {
-        time = time + "0";
-    }
-    time = time + std::to_string(hrs) + ":"; 
-    if (mins < 10) {
-        time = time + "0";
-    }
-    time = time + std::to_string(mins) + ":";
-    if (secs < 10) {
-        time = time + "0";
-    }
-    time = time + std::to_string(secs);
-    return time; 
-}
\ No newline at end of file
+    snprintf(buffer, size, "%02ld:%02d:%02d", hrs, mins, secs);
+    return buffer;
+}
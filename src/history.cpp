@@ -0,0 +1,27 @@
+#include <algorithm>
+
+#include "history.h"
+
+// Record a sample, overwriting the oldest one once the history is full
+void History::Add(float sample) {
+  samples_[next_] = sample;
+  next_ = (next_ + 1) % kSize;
+  size_ = std::min(size_ + 1, kSize);
+}
+
+// Return the number of samples recorded, up to kSize
+size_t History::Size() const { return size_; }
+
+// Return the sample recorded age samples ago
+float History::operator[](size_t age) const {
+  return samples_[(next_ + kSize - 1 - age) % kSize];
+}
+
+// Return the largest sample recorded, 0 if there is none
+float History::Max() const {
+  float max{0};
+  for (size_t age = 0; age < size_; ++age) {
+    max = std::max(max, (*this)[age]);
+  }
+  return max;
+}
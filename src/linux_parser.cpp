@@ -1,9 +1,16 @@
 #include <dirent.h>
+#include <fcntl.h>
 #include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
 
+#include "instrument.h"
 #include "linux_parser.h"
 
 using std::stof;
@@ -11,6 +18,95 @@ using std::string;
 using std::to_string;
 using std::vector;
 
+// Helper function, std::getline that also counts the bytes consumed
+std::istream& readLine(std::istream& stream, std::string& line) {
+  if (std::getline(stream, line)) {
+    Instrument::Count(Instrument::kBytesRead, line.size() + 1);
+  }
+  return stream;
+}
+
+// Helper function that reads a whole file into a buffer that is reused and
+// only ever grows, so reads on the sampling path do not allocate
+// The returned view is NUL terminated and valid until the next call
+std::string_view readFile(char const* filename) {
+  static thread_local vector<char> buffer(4096);
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return {};
+  }
+  size_t length{0};
+  while (true) {
+    if (length + 1 >= buffer.size()) {
+      buffer.resize(buffer.size() * 2);
+    }
+    ssize_t n = read(fd, buffer.data() + length, buffer.size() - 1 - length);
+    Instrument::BytesRead(n);
+    if (n <= 0) {
+      break;
+    }
+    length += n;
+  }
+  close(fd);
+  Instrument::FileOpened();
+  buffer[length] = '\0';
+  return {buffer.data(), length};
+}
+
+// Helper function that returns the number after a key at the start of a
+// line, e.g. 16318152 for "MemTotal:       16318152 kB"
+long findNumberByKey(std::string_view contents, std::string_view key) {
+  size_t line{0};
+  while (line < contents.size()) {
+    if (contents.compare(line, key.size(), key) == 0 &&
+        isspace(contents.data()[line + key.size()])) {
+      return strtol(contents.data() + line + key.size(), nullptr, 10);
+    }
+    line = contents.find('\n', line);
+    if (line == std::string_view::npos) {
+      break;
+    }
+    ++line;
+  }
+  return 0;
+}
+
+// Helper function that writes /proc/[PID]<filename> into a buffer
+char const* procPath(char* buffer, size_t size, int pid,
+                     std::string const& filename) {
+  snprintf(buffer, size, "%s%d%s", LinuxParser::kProcDirectory.c_str(), pid,
+           filename.c_str());
+  return buffer;
+}
+
+// Helper function that collects the numeric entries of a directory (PIDs or
+// TIDs) with getdents64 into a fixed buffer, instead of the heap allocated
+// stream of opendir
+void listNumericEntries(char const* path, vector<int>& ids) {
+  ids.clear();
+  int fd = open(path, O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    return;
+  }
+  alignas(struct dirent64) char buffer[32 * 1024];
+  while (true) {
+    ssize_t length = getdents64(fd, buffer, sizeof(buffer));
+    Instrument::BytesRead(length);
+    if (length <= 0) {
+      break;
+    }
+    for (ssize_t offset = 0; offset < length;) {
+      auto* entry = reinterpret_cast<struct dirent64*>(buffer + offset);
+      if (entry->d_type == DT_DIR && isdigit(entry->d_name[0])) {
+        ids.push_back(atoi(entry->d_name));
+      }
+      offset += entry->d_reclen;
+    }
+  }
+  close(fd);
+  Instrument::FileOpened();
+}
+
 // Helper function that reads value from file system given key
 template <typename T>
 T findValueByKey(std::string const &keyfilter, std::string const &filename) {
@@ -20,7 +116,8 @@ T findValueByKey(std::string const &keyfilter, std::string const &filename) {
 
   std::ifstream stream(filename);
   if (stream.is_open()) {
-    while (std::getline(stream, line)) {
+    Instrument::StreamOpened();
+    while (readLine(stream, line)) {
       std::istringstream linestream(line);
       while(linestream >> key >> value) {
         if (key == keyfilter) {
@@ -41,7 +138,8 @@ T findValue(std::string const& filename) {
 
   std::ifstream stream(filename);
   if (stream.is_open()) {
-    std::getline(stream, line);
+    Instrument::StreamOpened();
+    readLine(stream, line);
     std::istringstream linestream(line);
     linestream >> value;
   } 
@@ -56,7 +154,8 @@ string LinuxParser::OperatingSystem() {
   std::string value;
   std::ifstream filestream(kOSPath);
   if (filestream.is_open()) {
-    while (std::getline(filestream, line)) {
+    Instrument::StreamOpened();
+    while (readLine(filestream, line)) {
       std::replace(line.begin(), line.end(), ' ', '_');
       std::replace(line.begin(), line.end(), '=', ' ');
       std::replace(line.begin(), line.end(), '"', ' ');
@@ -81,7 +180,8 @@ string LinuxParser::Kernel() {
   std::string line;
   std::ifstream stream(kProcDirectory + kVersionFilename);
   if (stream.is_open()) {
-    std::getline(stream, line);
+    Instrument::StreamOpened();
+    readLine(stream, line);
     std::istringstream linestream(line);
     linestream >> os >> version >> kernel;
   }
@@ -91,145 +191,82 @@ string LinuxParser::Kernel() {
 }
 
 // Get a vector of currently running process ids
-vector<int> LinuxParser::Pids() {
-  vector<int> pids;
-  DIR* directory = opendir(kProcDirectory.c_str());
-  struct dirent* file;
-  while ((file = readdir(directory)) != nullptr) {
-    // Is this a directory?
-    if (file->d_type == DT_DIR) {
-      // Is every character of the name a digit?
-      string filename(file->d_name);
-      if (std::all_of(filename.begin(), filename.end(), isdigit)) {
-        int pid = stoi(filename);
-        pids.push_back(pid);
-      }
-    }
-  }
-  closedir(directory);
-  return pids;
+// The vector is filled in place so that its capacity is reused every tick
+void LinuxParser::Pids(vector<int>& pids) {
+  listNumericEntries(kProcDirectory.c_str(), pids);
 }
 
 // Reads and returns the system memory utilization as a percentage
 // From file: /proc/meminfo
 float LinuxParser::MemoryUtilization() {
-  float total;
-  float free;
-
-  total = findValueByKey<float>(filterMemTotalString, 
-                                kProcDirectory + kMeminfoFilename);
-  free = findValueByKey<float>(filterMemFreeString, 
-                               kProcDirectory + kMeminfoFilename);
-
+  std::string_view meminfo =
+      readFile((kProcDirectory + kMeminfoFilename).c_str());
+  float total = findNumberByKey(meminfo, filterMemTotalString);
+  float free = findNumberByKey(meminfo, filterMemFreeString);
+  if (total == 0) {
+    return 0;
+  }
   return (total - free) / total;
 }
 
 // Read and return the total system up time
 // From file: /proc/uptime
-long LinuxParser::UpTime() { 
-  long uptime;
-  uptime = findValue<long>(kProcDirectory + kUptimeFilename);
-  return uptime; 
+long LinuxParser::UpTime() {
+  std::string_view uptime =
+      readFile((kProcDirectory + kUptimeFilename).c_str());
+  return uptime.empty() ? 0 : strtol(uptime.data(), nullptr, 10);
+}
+
+// Read the aggregate jiffies of all CPUs, in the order of CPUStates
+// From file: /proc/stat, first line
+bool LinuxParser::CpuJiffies(long (&jiffies)[kGuestNice_ + 1]) {
+  std::string_view stat = readFile((kProcDirectory + kStatFilename).c_str());
+  if (stat.compare(0, filterCpu.size(), filterCpu) != 0) {
+    return false;
+  }
+  char* p = const_cast<char*>(stat.data()) + filterCpu.size();
+  for (long& value : jiffies) {
+    value = strtol(p, &p, 10);
+  }
+  return true;
 }
 
 // Return the total number of jiffies for the system
-long LinuxParser::Jiffies() { 
-  long total_jiffies;
-  long user; 
-  long nice;
-  long system;
-  long idle; 
-  long iowait; 
-  long irq; 
-  long softirq; 
-  long steal;
-  std::vector<string> utilizations = LinuxParser::CpuUtilization();
-  
-  user = stol(utilizations[kUser_]);
-  nice = stol(utilizations[kNice_]);
-  system = stol(utilizations[kSystem_]);
-  idle = stol(utilizations[kIdle_]);
-  iowait = stol(utilizations[kIOwait_]);
-  irq = stol(utilizations[kIRQ_]);
-  softirq = stol(utilizations[kSoftIRQ_]);
-  steal = stol(utilizations[kSteal_]);
-
-  total_jiffies = user + nice + system + idle + iowait + irq + softirq + steal;
-
-  return total_jiffies;
+// Formula: total = user + nice + system + idle + iowait + irq + softirq + steal
+long LinuxParser::Jiffies() {
+  long jiffies[kGuestNice_ + 1]{};
+  CpuJiffies(jiffies);
+  return jiffies[kUser_] + jiffies[kNice_] + jiffies[kSystem_] +
+         jiffies[kIdle_] + jiffies[kIOwait_] + jiffies[kIRQ_] +
+         jiffies[kSoftIRQ_] + jiffies[kSteal_];
 }
 
 // Read and return the number of active jiffies for a PID
 // From file: /proc/[PID]/stat
 // Formula: total active jiffies = utime + stime + cutime + cstime
 long LinuxParser::ActiveJiffies(int pid) {
-  long active_jiffies;
-  long utime;
-  long stime;
-  long cutime;
-  long cstime;
-  std::string line;
-  std::string value;
-  std::vector<string> values;
-
-  std::ifstream stream(kProcDirectory + to_string(pid) + kStatFilename);
-  if (stream.is_open()) {
-    std::getline(stream, line);
-    std::istringstream linestream(line);
-    for (int i = 0; i < 22; i++) {
-      linestream >> value;
-      values.emplace_back(value);
-    }
-  
-    utime = stol(values[13]);
-    stime = stol(values[14]);
-    cutime = stol(values [15]);
-    cstime = stol(values[16]);
-
-    active_jiffies = utime + stime + cutime + cstime;
+  Stat stat;
+  if (!ParseStat(pid, stat)) {
+    return 0;
   }
-  else { active_jiffies = 0; }
-
-  return active_jiffies;
+  return stat.utime + stat.stime + stat.cutime + stat.cstime;
 }
 
 // Return the number of active jiffies for the system
 // Formula: total active = user + nice + system + irq + softirq + steal
 long LinuxParser::ActiveJiffies() {
-  long active_jiffies;
-  long user; 
-  long nice; 
-  long system; 
-  long irq; 
-  long softirq; 
-  long steal;
-  std::vector<string> utilizations = LinuxParser::CpuUtilization();
-
-  user = stol(utilizations[kUser_]);
-  nice = stol(utilizations[kNice_]);
-  system = stol(utilizations[kSystem_]);
-  irq = stol(utilizations[kIRQ_]);
-  softirq = stol(utilizations[kSoftIRQ_]);
-  steal = stol(utilizations[kSteal_]);
-
-  active_jiffies = user + nice + system + irq + softirq + steal;
-
-  return active_jiffies;
+  long jiffies[kGuestNice_ + 1]{};
+  CpuJiffies(jiffies);
+  return jiffies[kUser_] + jiffies[kNice_] + jiffies[kSystem_] +
+         jiffies[kIRQ_] + jiffies[kSoftIRQ_] + jiffies[kSteal_];
 }
 
 // Return the number of idle jiffies for the system
 // formula: total idle = idle + iowait
 long LinuxParser::IdleJiffies() {
-  long idle_jiffies;
-  long idle;
-  long iowait;
-  std::vector<string> utilizations = LinuxParser::CpuUtilization();
-  idle = stol(utilizations[kIdle_]);
-  iowait = stol(utilizations[kIOwait_]);
-
-  idle_jiffies = idle + iowait;
-  
-  return idle_jiffies;
+  long jiffies[kGuestNice_ + 1]{};
+  CpuJiffies(jiffies);
+  return jiffies[kIdle_] + jiffies[kIOwait_];
 }
 
 // Read and return a vector CPU utilizations in order:
@@ -241,7 +278,8 @@ vector<string> LinuxParser::CpuUtilization() {
   string value;
   std::ifstream stream(kProcDirectory + kStatFilename);
   if (stream.is_open()) {
-    std::getline(stream, line);
+    Instrument::StreamOpened();
+    readLine(stream, line);
     std::istringstream linestream(line);
     linestream >> cpu;
     while(linestream >> value) {
@@ -253,40 +291,76 @@ vector<string> LinuxParser::CpuUtilization() {
 
 // Read and return the total number of processes
 // From file: /proc/stat
-int LinuxParser::TotalProcesses() { 
-  int total_processes;
-  total_processes = findValueByKey<int>(filterProcesses,
-                                        kProcDirectory + kStatFilename);
-  return total_processes;
+int LinuxParser::TotalProcesses() {
+  std::string_view stat = readFile((kProcDirectory + kStatFilename).c_str());
+  return findNumberByKey(stat, filterProcesses);
 }
 
 // Read and return the number of running processes
 // From file: /proc/stat
-int LinuxParser::RunningProcesses() { 
-  int running_processes;
-  running_processes = findValueByKey<int>(filterRunningProcesses,
-                                        kProcDirectory + kStatFilename);
-  return running_processes;
- }
+int LinuxParser::RunningProcesses() {
+  std::string_view stat = readFile((kProcDirectory + kStatFilename).c_str());
+  return findNumberByKey(stat, filterRunningProcesses);
+}
+
+// Read the command associated with a process into buffer
+// From file: /proc/[PID]/cmdline, or /proc/[PID]/comm for kernel threads
+// The NUL separated arguments are joined with spaces and the result is
+// truncated to the size of the buffer. Returns the length of the command.
+size_t LinuxParser::Command(int pid, char* buffer, size_t size) {
+  char path[64];
+  ssize_t length{0};
+  int fd = open(procPath(path, sizeof(path), pid, kCmdlineFilename), O_RDONLY);
+  if (fd >= 0) {
+    length = read(fd, buffer, size);
+    close(fd);
+    Instrument::FileOpened();
+    Instrument::BytesRead(length);
+  }
+  if (length > 0) {
+    while (length > 0 && buffer[length - 1] == '\0') {
+      --length;
+    }
+    std::replace(buffer, buffer + length, '\0', ' ');
+    return length;
+  }
 
-// Read and return the command associated with a process
-// From file: /proc/[PID]/cmdline
-std::string LinuxParser::Command(int pid) {
-  std::string command;
-  command = findValue<std::string>(kProcDirectory + to_string(pid)
-                                    + kCmdlineFilename);
-  return command;
+  // kernel threads have an empty command line, show their name instead
+  if (size < 3) {
+    return 0;
+  }
+  fd = open(procPath(path, sizeof(path), pid, kCommFilename), O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  length = read(fd, buffer + 1, size - 2);
+  close(fd);
+  Instrument::FileOpened();
+  Instrument::BytesRead(length);
+  if (length > 0 && buffer[length] == '\n') {
+    --length;
+  }
+  if (length <= 0) {
+    return 0;
+  }
+  buffer[0] = '[';
+  buffer[length + 1] = ']';
+  return length + 2;
 }
 
-// Read and return the memory used by a process
+// Read the uid and the memory used by a process in a single read
 // From file: /proc/[PID]/status
-std::string LinuxParser::Ram(int pid) { 
-  std::string ram;
-  ram = findValueByKey<std::string>(filterProcMem,
-                                    kProcDirectory + to_string(pid) 
-                                    + kStatusFilename);
-  ram = to_string(stol(ram) / static_cast<long>(1000));
-  return ram;
+bool LinuxParser::ParseStatus(int pid, Status& status) {
+  char path[64];
+  std::string_view contents =
+      readFile(procPath(path, sizeof(path), pid, kStatusFilename));
+  if (contents.empty()) {
+    return false;
+  }
+  status.uid = findNumberByKey(contents, filterUID);
+  // kernel threads have no VmData
+  status.vm_data = findNumberByKey(contents, filterProcMem);
+  return true;
 }
 
 // Read and return the user ID associated with a process
@@ -310,7 +384,8 @@ std::string LinuxParser::User(int pid) {
   std::string uid_cand;
   std::ifstream stream(kPasswordPath);
   if (stream.is_open()) {
-    while (std::getline(stream, line)) {
+    Instrument::StreamOpened();
+    while (readLine(stream, line)) {
         std::replace(line.begin(), line.end(), ':', ' ');
         std::istringstream linestream(line);
         linestream >> value >> x >> uid_cand;
@@ -324,25 +399,321 @@ std::string LinuxParser::User(int pid) {
   return user; 
 }
 
+// Read and return the name of a user ID, or an empty string if unknown
+// From file: /etc/passwd
+std::string LinuxParser::UserName(long uid) {
+  std::string line;
+  std::string name;
+  std::string x;
+  long uid_cand;
+  std::ifstream stream(kPasswordPath);
+  if (stream.is_open()) {
+    Instrument::StreamOpened();
+    while (readLine(stream, line)) {
+      std::replace(line.begin(), line.end(), ':', ' ');
+      std::istringstream linestream(line);
+      if (linestream >> name >> x >> uid_cand && uid_cand == uid) {
+        return name;
+      }
+    }
+  }
+  return "";
+}
+
 // Read and return the uptime of a process
 // From file: /proc/[PID]/stat
 // Formula: (system uptime) - (process startime)
 long LinuxParser::UpTime(int pid) {
-  long proc_uptime; 
-  long sys_uptime;
-  std::string line;
-  std::string value;
-  std::ifstream stream(kProcDirectory + to_string(pid) + kStatFilename);
-  if (stream.is_open()) {
-    std::getline(stream, line);
-    std::istringstream linestream(line);
-    for (int i = 0; i < 22; i++) {
-      linestream >> value;
+  Stat stat;
+  if (!ParseStat(pid, stat)) {
+    return 0;
+  }
+  return LinuxParser::UpTime() - stat.starttime / sysconf(_SC_CLK_TCK);
+}
+
+// Parse the fields of a stat line with a single read and no stream objects
+// From file: /proc/[PID]/stat or /proc/[PID]/task/[TID]/stat
+// Field numbers follow proc(5): 3 state, 4 ppid, 14 utime, 15 stime,
+// 16 cutime, 17 cstime, 22 starttime, 39 processor
+bool LinuxParser::ParseStat(char const* filename, Stat& stat) {
+  char buffer[1024];
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  ssize_t length = read(fd, buffer, sizeof(buffer) - 1);
+  close(fd);
+  Instrument::FileOpened();
+  Instrument::BytesRead(length);
+  if (length <= 0) {
+    return false;
+  }
+  buffer[length] = '\0';
+
+  // the command name (field 2) may itself contain spaces and parentheses,
+  // so start after the last closing parenthesis
+  char* p = strrchr(buffer, ')');
+  char* name = strchr(buffer, '(');
+  if (p == nullptr || name == nullptr || name > p) {
+    return false;
+  }
+  ++name;
+  size_t name_length = std::min<size_t>(p - name, sizeof(stat.name) - 1);
+  memcpy(stat.name, name, name_length);
+  stat.name[name_length] = '\0';
+  ++p;
+  for (int field = 3; field <= 39 && *p != '\0'; ++field) {
+    while (*p == ' ') {
+      ++p;
+    }
+    if (field == 3) {
+      stat.state = *p;
+    } else {
+      long value = strtol(p, nullptr, 10);
+      switch (field) {
+        case 4: stat.ppid = static_cast<int>(value); break;
+        case 14: stat.utime = value; break;
+        case 15: stat.stime = value; break;
+        case 16: stat.cutime = value; break;
+        case 17: stat.cstime = value; break;
+        case 22: stat.starttime = value; break;
+        case 39: stat.processor = static_cast<int>(value); break;
+      }
+    }
+    while (*p != ' ' && *p != '\0') {
+      ++p;
+    }
+  }
+  return true;
+}
+
+// Parse the stat file of a process
+// From file: /proc/[PID]/stat
+bool LinuxParser::ParseStat(int pid, Stat& stat) {
+  char path[64];
+  return ParseStat(procPath(path, sizeof(path), pid, kStatFilename), stat);
+}
+
+// Parse the stat file of one thread of a process
+// From file: /proc/[PID]/task/[TID]/stat
+bool LinuxParser::ParseStat(int pid, int tid, Stat& stat) {
+  char path[96];
+  snprintf(path, sizeof(path), "%s%d%s%d%s", kProcDirectory.c_str(), pid,
+           kTaskDirectory.c_str(), tid, kStatFilename.c_str());
+  return ParseStat(path, stat);
+}
+
+// Get a vector of the thread ids of a process
+// From directory: /proc/[PID]/task
+void LinuxParser::Tids(int pid, vector<int>& tids) {
+  char path[64];
+  listNumericEntries(procPath(path, sizeof(path), pid, kTaskDirectory), tids);
+}
+
+// Read the counters of every network interface in a single pass
+// From file: /proc/net/dev
+// After two header lines, every line is "<name>: " followed by 8 receive
+// counters (bytes packets errs drop fifo frame compressed multicast) and
+// 8 transmit counters (bytes packets errs drop fifo colls carrier compressed)
+void LinuxParser::NetDevices(vector<NetDevice>& devices) {
+  devices.clear();
+  std::string_view contents =
+      readFile((kProcDirectory + kNetDevFilename).c_str());
+  size_t line = contents.find('\n');
+  line = line == std::string_view::npos ? line : contents.find('\n', line + 1);
+  while (line != std::string_view::npos && line + 1 < contents.size()) {
+    char const* p = contents.data() + line + 1;
+    while (*p == ' ') {
+      ++p;
+    }
+    char const* colon = strchr(p, ':');
+    if (colon == nullptr) {
+      break;
+    }
+    NetDevice device;
+    size_t length = std::min<size_t>(colon - p, sizeof(device.name) - 1);
+    memcpy(device.name, p, length);
+    char* q = const_cast<char*>(colon + 1);
+    long counters[16];
+    for (long& counter : counters) {
+      counter = strtol(q, &q, 10);
+    }
+    device.rx_bytes = counters[0];
+    device.rx_packets = counters[1];
+    device.rx_drop = counters[3];
+    device.tx_bytes = counters[8];
+    device.tx_packets = counters[9];
+    device.tx_drop = counters[11];
+    devices.push_back(device);
+    line = contents.find('\n', line + 1);
+  }
+}
+
+// Read the inodes of all TCP sockets of the system
+// From files: /proc/net/tcp and /proc/net/tcp6, 10th column
+// Sockets in TIME_WAIT have no inode (0) and are skipped
+void LinuxParser::TcpInodes(vector<unsigned long>& inodes) {
+  inodes.clear();
+  for (auto const* filename : {&kTcpFilename, &kTcp6Filename}) {
+    std::string_view contents =
+        readFile((kProcDirectory + *filename).c_str());
+    // skip the header line
+    size_t line = contents.find('\n');
+    while (line != std::string_view::npos && line + 1 < contents.size()) {
+      char* p = const_cast<char*>(contents.data()) + line + 1;
+      for (int column = 1; column < 10; ++column) {
+        while (*p == ' ') {
+          ++p;
+        }
+        while (*p != ' ' && *p != '\0') {
+          ++p;
+        }
+      }
+      unsigned long inode = strtoul(p, nullptr, 10);
+      if (inode != 0) {
+        inodes.push_back(inode);
+      }
+      line = contents.find('\n', line + 1);
+    }
+  }
+}
+
+// Read the inodes of the sockets a process has open
+// From directory: /proc/[PID]/fd, whose links read "socket:[<inode>]"
+// Only readable for processes of the same user unless running as root
+void LinuxParser::SocketInodes(int pid, vector<unsigned long>& inodes) {
+  inodes.clear();
+  char path[64];
+  int fd = open(procPath(path, sizeof(path), pid, kFdDirectory),
+                O_RDONLY | O_DIRECTORY);
+  if (fd < 0) {
+    return;
+  }
+  alignas(struct dirent64) char buffer[16 * 1024];
+  char link[64];
+  while (true) {
+    ssize_t length = getdents64(fd, buffer, sizeof(buffer));
+    Instrument::BytesRead(length);
+    if (length <= 0) {
+      break;
+    }
+    for (ssize_t offset = 0; offset < length;) {
+      auto* entry = reinterpret_cast<struct dirent64*>(buffer + offset);
+      offset += entry->d_reclen;
+      if (entry->d_type != DT_LNK) {
+        continue;
+      }
+      ssize_t n = readlinkat(fd, entry->d_name, link, sizeof(link) - 1);
+      Instrument::Count(Instrument::kSyscalls);
+      if (n > 8 && strncmp(link, "socket:[", 8) == 0) {
+        link[n] = '\0';
+        inodes.push_back(strtoul(link + 8, nullptr, 10));
+      }
+    }
+  }
+  close(fd);
+  Instrument::FileOpened();
+}
+
+// Read the I/O counters of every block device
+// From file: /proc/diskstats
+// Every line is "<major> <minor> <name>" followed by reads completed,
+// reads merged, sectors read, time reading, the same four for writes,
+// I/Os in progress, time doing I/O and (newer kernels) more counters
+void LinuxParser::DiskStats(vector<DiskStat>& disks) {
+  static const string path{kProcDirectory + kDiskStatsFilename};
+  disks.clear();
+  std::string_view contents = readFile(path.c_str());
+  char* p = const_cast<char*>(contents.data());
+  char* end = p + contents.size();
+  while (p < end) {
+    DiskStat disk;
+    strtol(p, &p, 10);
+    strtol(p, &p, 10);
+    while (*p == ' ') {
+      ++p;
+    }
+    size_t length = strcspn(p, " \n");
+    memcpy(disk.name, p, std::min(length, sizeof(disk.name) - 1));
+    p += length;
+    long counters[10];
+    for (long& counter : counters) {
+      counter = strtol(p, &p, 10);
+    }
+    disk.reads = counters[0];
+    disk.read_sectors = counters[2];
+    disk.read_time = counters[3];
+    disk.writes = counters[4];
+    disk.write_sectors = counters[6];
+    disk.write_time = counters[7];
+    disk.io_time = counters[9];
+    disks.push_back(disk);
+    p = strchr(p, '\n');
+    if (p == nullptr) {
+      break;
     }
-    sys_uptime = LinuxParser::UpTime();
-    proc_uptime = sys_uptime - long(stol(value) / sysconf(_SC_CLK_TCK));
+    ++p;
   }
-  else { proc_uptime = 0; }
-  
-  return proc_uptime;
-  }
\ No newline at end of file
+}
+
+// Return whether a block device is a partition, a disk backed by hardware
+// (or a RAID / device mapper volume on top of disks) or a virtual device
+// such as a loop or RAM disk
+// From directory: /sys/class/block/[NAME]
+LinuxParser::DiskKinds LinuxParser::DiskKind(char const* name) {
+  char path[128];
+  auto exists = [&path, name](char const* entry) {
+    snprintf(path, sizeof(path), "%s%s/%s", kBlockDirectory.c_str(), name,
+             entry);
+    Instrument::Count(Instrument::kSyscalls);
+    return access(path, F_OK) == 0;
+  };
+  if (exists("partition")) {
+    return kPartition_;
+  }
+  if (exists("device") || exists("md") || exists("dm")) {
+    return kDisk_;
+  }
+  return kVirtualDisk_;
+}
+
+// Read and return the NUMA node of every CPU, indexed by CPU number
+// From files: /sys/devices/system/node/node[N]/cpulist
+// A cpulist looks like "0-3,8-11". Without NUMA support all CPUs are node 0.
+vector<int> LinuxParser::CpuNodes() {
+  vector<int> nodes(sysconf(_SC_NPROCESSORS_CONF), 0);
+  DIR* directory = opendir(kNodeDirectory.c_str());
+  if (directory == nullptr) {
+    return nodes;
+  }
+  Instrument::StreamOpened();
+  struct dirent* file;
+  while ((file = readdir(directory)) != nullptr) {
+    if (strncmp(file->d_name, "node", 4) != 0 || !isdigit(file->d_name[4])) {
+      continue;
+    }
+    int node = atoi(file->d_name + 4);
+    string cpulist;
+    std::ifstream stream(kNodeDirectory + file->d_name + kCpulistFilename);
+    Instrument::StreamOpened();
+    if (!readLine(stream, cpulist)) {
+      continue;
+    }
+    std::replace(cpulist.begin(), cpulist.end(), ',', ' ');
+    std::istringstream linestream(cpulist);
+    string range;
+    while (linestream >> range) {
+      size_t dash = range.find('-');
+      int first = stoi(range.substr(0, dash));
+      int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) {
+        if (cpu >= static_cast<int>(nodes.size())) {
+          nodes.resize(cpu + 1, 0);
+        }
+        nodes[cpu] = node;
+      }
+    }
+  }
+  closedir(directory);
+  return nodes;
+}
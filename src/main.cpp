@@ -1,7 +1,79 @@
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "batch_display.h"
+#include "metrics_server.h"
 #include "ncurses_display.h"
 #include "system.h"
 
-int main() {
+int main(int argc, char* argv[]) {
   System system;
-  NCursesDisplay::Display(system);
-}
\ No newline at end of file
+  int batch_ticks{-1};
+  std::string serve_address;
+  int serve_top_k{20};
+  for (int i = 1; i < argc; ++i) {
+    std::string arg{argv[i]};
+    // --threads-top K: collect the threads of the K busiest processes
+    if (arg == "--threads-top" && i + 1 < argc) {
+      system.setThreadTopK(std::atoi(argv[++i]));
+    }
+    // --cmd-length N: keep at most N characters of each command line,
+    // 1 to Process::kMaxCommandLength
+    if (arg == "--cmd-length" && i + 1 < argc) {
+      char* end;
+      long length = std::strtol(argv[++i], &end, 10);
+      if (*end != '\0' || length <= 0 ||
+          length > static_cast<long>(Process::kMaxCommandLength)) {
+        std::cerr << "invalid command length: " << argv[i] << " (1 to "
+                  << Process::kMaxCommandLength << ")\n";
+        return 1;
+      }
+      Process::setCommandLength(length);
+    }
+    // --filter EXPRESSION: only show processes matching the expression
+    if (arg == "--filter" && i + 1 < argc) {
+      if (!system.setFilter(argv[++i])) {
+        std::cerr << "invalid filter: " << argv[i] << "\n";
+        return 1;
+      }
+    }
+    // --sockets: show the number of TCP sockets of every process
+    if (arg == "--sockets") {
+      system.setSockets(true);
+    }
+    // --partitions: show partitions in the disk panel, not only disks
+    if (arg == "--partitions") {
+      system.Disks().setPartitions(true);
+    }
+    // --batch TICKS: print TICKS plain text snapshots (0: run forever)
+    if (arg == "--batch" && i + 1 < argc) {
+      batch_ticks = std::atoi(argv[++i]);
+    }
+    // --serve ADDRESS: export Prometheus metrics on a port or Unix socket
+    if (arg == "--serve" && i + 1 < argc) {
+      serve_address = argv[++i];
+    }
+    // --serve-top K: export the K busiest processes (default 20)
+    if (arg == "--serve-top" && i + 1 < argc) {
+      serve_top_k = std::atoi(argv[++i]);
+    }
+  }
+  if (!serve_address.empty()) {
+    MetricsServer server(serve_address, serve_top_k);
+    if (!server.Start()) {
+      std::cerr << "cannot serve on " << serve_address << ": "
+                << std::strerror(errno) << "\n";
+      return 1;
+    }
+    server.Run(system);
+    return 0;
+  }
+  if (batch_ticks >= 0) {
+    BatchDisplay::Display(system, batch_ticks);
+  } else {
+    NCursesDisplay::Display(system);
+  }
+}
@@ -0,0 +1,335 @@
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+
+#include "metrics_server.h"
+
+using std::string;
+
+namespace {
+// set by SIGINT or SIGTERM to end Run()
+volatile std::sig_atomic_t stop_requested{0};
+
+void RequestStop(int) { stop_requested = 1; }
+
+char const* const kStageNames[Instrument::kStageCount]{
+    "pids", "parse", "user", "sort", "system", "draw"};
+
+// Append a label value, escaping backslashes, quotes and newlines
+void appendLabel(string& out, std::string_view value) {
+  for (char c : value) {
+    if (c == '\\' || c == '"') {
+      out += '\\';
+      out += c;
+    } else if (c == '\n') {
+      out += "\\n";
+    } else {
+      out += c;
+    }
+  }
+}
+
+// Append a printf formatted line
+template <typename... Args>
+void appendf(string& out, char const* format, Args... args) {
+  char line[256];
+  int length = snprintf(line, sizeof(line), format, args...);
+  out.append(line, std::min<size_t>(length, sizeof(line) - 1));
+}
+}  // namespace
+
+MetricsServer::MetricsServer(string const& address, int top_k)
+    : address_(address), top_k_(top_k) {}
+
+// Stop the server thread by shutting down its listening socket, and
+// remove the socket file of a Unix socket
+MetricsServer::~MetricsServer() {
+  if (listen_fd_ >= 0) {
+    shutdown(listen_fd_, SHUT_RDWR);
+    close(listen_fd_);
+  }
+  if (server_.joinable()) {
+    server_.join();
+  }
+  if (bound_socket_file_) {
+    unlink(address_.c_str());
+  }
+}
+
+// Bind and listen on the address and start the server thread
+// Returns false, with errno set, if the address is invalid or cannot be
+// bound. A stale Unix socket is replaced, but any other file at the path
+// is left alone (EEXIST).
+bool MetricsServer::Start() {
+  if (address_.find('/') != string::npos) {
+    struct sockaddr_un local {};
+    local.sun_family = AF_UNIX;
+    if (address_.size() >= sizeof(local.sun_path)) {
+      errno = ENAMETOOLONG;
+      return false;
+    }
+    strcpy(local.sun_path, address_.c_str());
+    struct stat existing;
+    if (lstat(local.sun_path, &existing) == 0) {
+      if (!S_ISSOCK(existing.st_mode)) {
+        errno = EEXIST;
+        return false;
+      }
+      unlink(local.sun_path);
+    }
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd_ < 0 ||
+        bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&local),
+             sizeof(local)) != 0) {
+      return false;
+    }
+    bound_socket_file_ = true;
+  } else {
+    // only localhost unless a host is given
+    string host{"127.0.0.1"};
+    string port{address_};
+    size_t colon = address_.rfind(':');
+    if (colon != string::npos) {
+      host = address_.substr(0, colon);
+      port = address_.substr(colon + 1);
+    }
+    struct sockaddr_in local {};
+    local.sin_family = AF_INET;
+    local.sin_port = htons(atoi(port.c_str()));
+    if (local.sin_port == 0 ||
+        inet_pton(AF_INET, host.c_str(), &local.sin_addr) != 1) {
+      errno = EINVAL;
+      return false;
+    }
+    listen_fd_ = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+      return false;
+    }
+    int reuse{1};
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&local),
+             sizeof(local)) != 0) {
+      return false;
+    }
+  }
+  if (listen(listen_fd_, 16) != 0) {
+    return false;
+  }
+  server_ = std::thread(&MetricsServer::Serve, this);
+  return true;
+}
+
+// Sample the system once per second and publish each snapshot, until
+// SIGINT or SIGTERM is received
+void MetricsServer::Run(System& system) {
+  std::signal(SIGINT, RequestStop);
+  std::signal(SIGTERM, RequestStop);
+  while (!stop_requested) {
+    std::shared_ptr<Snapshot> snapshot = Sample(system);
+    std::shared_ptr<Snapshot const> previous = Latest();
+    Publish(snapshot);
+    // the replaced snapshot is reused once no scrape holds it any more
+    spare_ = std::const_pointer_cast<Snapshot>(previous);
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+  }
+}
+
+// Walk /proc and copy the system metrics and the top-K visible processes
+// into a snapshot. The spare snapshot is reused when possible, so that its
+// vector and strings keep their capacity.
+std::shared_ptr<MetricsServer::Snapshot> MetricsServer::Sample(
+    System& system) {
+  std::shared_ptr<Snapshot> snapshot;
+  if (spare_ && spare_.use_count() == 1) {
+    // use_count() is a relaxed load; the fence orders the last scrape's
+    // reads of the snapshot (before it released its reference) before the
+    // writes below
+    std::atomic_thread_fence(std::memory_order_acquire);
+    snapshot = std::move(spare_);
+  } else {
+    snapshot = std::make_shared<Snapshot>();
+  }
+  snapshot->cpu = system.Cpu().Utilization();
+  snapshot->memory = system.MemoryUtilization();
+  snapshot->uptime = system.UpTime();
+  snapshot->total_processes = system.TotalProcesses();
+  snapshot->running_processes = system.RunningProcesses();
+
+  std::vector<Process>& processes = system.Processes();
+  size_t count{0};
+  while (count < processes.size() && count < size_t(top_k_) &&
+         processes[count].Visible()) {
+    ++count;
+  }
+  snapshot->processes.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    ProcessSample& sample = snapshot->processes[i];
+    sample.pid = processes[i].Pid();
+    sample.user.assign(processes[i].User());
+    // comm rather than the command line: bounded label values, and
+    // arguments (which may hold secrets) are not handed to every scraper
+    sample.name.assign(processes[i].Name());
+    sample.cpu = processes[i].CpuUtilization();
+    sample.ram_kb = processes[i].RamKb();
+    sample.uptime = processes[i].UpTime();
+  }
+  snapshot->costs = Instrument::Collect();
+  snapshot->timestamp_ms =
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count();
+  return snapshot;
+}
+
+// Make a snapshot the one served to scrapes
+void MetricsServer::Publish(std::shared_ptr<Snapshot const> snapshot) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  latest_ = std::move(snapshot);
+}
+
+// Return the latest snapshot; the lock only covers copying the pointer
+std::shared_ptr<MetricsServer::Snapshot const> MetricsServer::Latest() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return latest_;
+}
+
+// Accept connections one at a time and answer GET /metrics
+void MetricsServer::Serve() {
+  char request[4096];
+  while (true) {
+    int fd = accept(listen_fd_, nullptr, nullptr);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      return;
+    }
+    // do not let a client that never sends its request block the server
+    struct timeval timeout {1, 0};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    ssize_t length = recv(fd, request, sizeof(request) - 1, 0);
+    if (length > 0) {
+      request[length] = '\0';
+      std::shared_ptr<Snapshot const> snapshot = Latest();
+      // the path is /metrics exactly, optionally with a query string
+      bool metrics = strncmp(request, "GET /metrics", 12) == 0 &&
+                     (request[12] == ' ' || request[12] == '?');
+      if (metrics && snapshot) {
+        Render(*snapshot);
+      } else {
+        response_.assign(
+            "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n"
+            "Connection: close\r\n\r\n");
+      }
+      for (size_t sent = 0; sent < response_.size();) {
+        ssize_t n = send(fd, response_.data() + sent, response_.size() - sent,
+                         MSG_NOSIGNAL);
+        if (n <= 0) {
+          break;
+        }
+        sent += n;
+      }
+    }
+    close(fd);
+  }
+}
+
+// Render a snapshot as an HTTP response in the Prometheus text format
+void MetricsServer::Render(Snapshot const& snapshot) {
+  string& out = body_;
+  out.clear();
+  out += "# HELP monitor_snapshot_timestamp_seconds When the snapshot was "
+         "taken.\n"
+         "# TYPE monitor_snapshot_timestamp_seconds gauge\n";
+  appendf(out, "monitor_snapshot_timestamp_seconds %.3f\n",
+          snapshot.timestamp_ms / 1e3);
+  out += "# HELP monitor_cpu_utilization_ratio Aggregate CPU utilization.\n"
+         "# TYPE monitor_cpu_utilization_ratio gauge\n";
+  appendf(out, "monitor_cpu_utilization_ratio %f\n", snapshot.cpu);
+  out += "# HELP monitor_memory_utilization_ratio Memory in use.\n"
+         "# TYPE monitor_memory_utilization_ratio gauge\n";
+  appendf(out, "monitor_memory_utilization_ratio %f\n", snapshot.memory);
+  out += "# HELP monitor_uptime_seconds Time since boot.\n"
+         "# TYPE monitor_uptime_seconds gauge\n";
+  appendf(out, "monitor_uptime_seconds %ld\n", snapshot.uptime);
+  out += "# HELP monitor_forks_total Processes created since boot.\n"
+         "# TYPE monitor_forks_total counter\n";
+  appendf(out, "monitor_forks_total %d\n", snapshot.total_processes);
+  out += "# HELP monitor_processes_running Processes in the run queue.\n"
+         "# TYPE monitor_processes_running gauge\n";
+  appendf(out, "monitor_processes_running %d\n", snapshot.running_processes);
+
+  // the top-K processes by CPU
+  struct {
+    char const* name;
+    char const* help;
+  } const process_metrics[]{
+      {"monitor_process_cpu_utilization_ratio",
+       "CPU utilization of the busiest processes."},
+      {"monitor_process_data_bytes", "Data segment size (VmData)."},
+      {"monitor_process_uptime_seconds", "Time since the process started."}};
+  for (int metric = 0; metric < 3; ++metric) {
+    appendf(out, "# HELP %s %s\n# TYPE %s gauge\n",
+            process_metrics[metric].name, process_metrics[metric].help,
+            process_metrics[metric].name);
+    for (auto const& process : snapshot.processes) {
+      appendf(out, "%s{pid=\"%d\",user=\"", process_metrics[metric].name,
+              process.pid);
+      appendLabel(out, process.user);
+      out += "\",comm=\"";
+      appendLabel(out, process.name);
+      switch (metric) {
+        case 0: appendf(out, "\"} %f\n", process.cpu); break;
+        case 1: appendf(out, "\"} %ld\n", process.ram_kb * 1024); break;
+        case 2: appendf(out, "\"} %ld\n", process.uptime); break;
+      }
+    }
+  }
+
+  // the monitor's own cost
+  out += "# HELP monitor_self_stage_seconds_total Time spent per stage, "
+         "excluding the stages nested in it.\n"
+         "# TYPE monitor_self_stage_seconds_total counter\n";
+  for (int stage = 0; stage < Instrument::kStageCount; ++stage) {
+    appendf(out, "monitor_self_stage_seconds_total{stage=\"%s\"} %f\n",
+            kStageNames[stage], snapshot.costs.nanoseconds[stage] / 1e9);
+  }
+  out += "# TYPE monitor_self_syscalls_total counter\n";
+  appendf(out, "monitor_self_syscalls_total %ld\n",
+          snapshot.costs.counters[Instrument::kSyscalls]);
+  out += "# HELP monitor_self_estimated_syscalls_total Reads of buffered "
+         "streams, estimated as one per stream.\n"
+         "# TYPE monitor_self_estimated_syscalls_total counter\n";
+  appendf(out, "monitor_self_estimated_syscalls_total %ld\n",
+          snapshot.costs.counters[Instrument::kEstimatedSyscalls]);
+  out += "# TYPE monitor_self_files_opened_total counter\n";
+  appendf(out, "monitor_self_files_opened_total %ld\n",
+          snapshot.costs.counters[Instrument::kFilesOpened]);
+  out += "# TYPE monitor_self_read_bytes_total counter\n";
+  appendf(out, "monitor_self_read_bytes_total %ld\n",
+          snapshot.costs.counters[Instrument::kBytesRead]);
+  out += "# TYPE monitor_self_allocations_total counter\n";
+  appendf(out, "monitor_self_allocations_total %ld\n",
+          snapshot.costs.counters[Instrument::kAllocations]);
+
+  response_.clear();
+  appendf(response_,
+          "HTTP/1.1 200 OK\r\n"
+          "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+          "Content-Length: %zu\r\nConnection: close\r\n\r\n",
+          out.size());
+  response_ += out;
+}
@@ -1,85 +1,403 @@
 #include <curses.h>
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
 #include "format.h"
+#include "instrument.h"
 #include "ncurses_display.h"
 #include "system.h"
 
-using std::string;
-using std::to_string;
 
 // 50 bars uniformly displayed from 0 - 100 %
 // 2% is one bar(|)
-std::string NCursesDisplay::ProgressBar(float percent) {
-  std::string result{"0%"};
+// Drawn at the cursor position of the window
+void NCursesDisplay::ProgressBar(float percent, WINDOW* window) {
   int size{50};
   float bars{percent * size};
 
+  waddstr(window, "0%");
   for (int i{0}; i < size; ++i) {
-    result += i <= bars ? '|' : ' ';
+    waddch(window, i <= bars ? '|' : ' ');
   }
 
-  string display{to_string(percent * 100).substr(0, 4)};
-  if (percent < 0.1 || percent == 1.0)
-    display = " " + to_string(percent * 100).substr(0, 3);
-  return result + " " + display + "/100%";
+  char display[32];
+  snprintf(display, sizeof(display), "%f", percent * 100);
+  if (percent < 0.1 || percent == 1.0) {
+    wprintw(window, "  %.3s/100%%", display);
+  } else {
+    wprintw(window, " %.4s/100%%", display);
+  }
+}
+
+// The last width samples of a history, newest on the right, each drawn as
+// one of 10 characters from empty (0) to full (max)
+// Drawn at the cursor position of the window
+void NCursesDisplay::Sparkline(History const& history, float max, int width,
+                               WINDOW* window) {
+  static char const levels[] = " .:-=+*#%@";
+  int const top{sizeof(levels) - 2};
+  for (int i = width - 1; i >= 0; --i) {
+    if (static_cast<size_t>(i) >= history.Size()) {
+      waddch(window, ' ');
+      continue;
+    }
+    float level = max > 0 ? history[i] / max * top : 0;
+    waddch(window, levels[std::clamp(static_cast<int>(level + 0.5f), 0, top)]);
+  }
 }
 
 void NCursesDisplay::DisplaySystem(System& system, WINDOW* window) {
   int row{0};
-  mvwprintw(window, ++row, 2, ("OS: " + system.OperatingSystem()).c_str());
-  mvwprintw(window, ++row, 2, ("Kernel: " + system.Kernel()).c_str());
+  char time[32];
+  mvwprintw(window, ++row, 2, "OS: %s", system.OperatingSystem().c_str());
+  mvwprintw(window, ++row, 2, "Kernel: %s", system.Kernel().c_str());
   mvwprintw(window, ++row, 2, "CPU: ");
   wattron(window, COLOR_PAIR(1));
-  mvwprintw(window, row, 10, "");
-  wprintw(window, ProgressBar(system.Cpu().Utilization()).c_str());
+  wmove(window, row, 10);
+  ProgressBar(system.Cpu().Utilization(), window);
+  wattroff(window, COLOR_PAIR(1));
+  mvwprintw(window, ++row, 2, "History: ");
+  wattron(window, COLOR_PAIR(1));
+  wmove(window, row, 12);
+  Sparkline(system.Cpu().UtilizationHistory(), 1.0, 50, window);
   wattroff(window, COLOR_PAIR(1));
   mvwprintw(window, ++row, 2, "Memory: ");
   wattron(window, COLOR_PAIR(1));
-  mvwprintw(window, row, 10, "");
-  wprintw(window, ProgressBar(system.MemoryUtilization()).c_str());
+  wmove(window, row, 10);
+  ProgressBar(system.MemoryUtilization(), window);
   wattroff(window, COLOR_PAIR(1));
-  mvwprintw(window, ++row, 2,
-            ("Total Processes: " + to_string(system.TotalProcesses())).c_str());
-  mvwprintw(
-      window, ++row, 2,
-      ("Running Processes: " + to_string(system.RunningProcesses())).c_str());
-  mvwprintw(window, ++row, 2,
-            ("Up Time: " + Format::ElapsedTime(system.UpTime())).c_str());
+  mvwprintw(window, ++row, 2, "Total Processes: %d", system.TotalProcesses());
+  mvwprintw(window, ++row, 2, "Running Processes: %d",
+            system.RunningProcesses());
+  mvwprintw(window, ++row, 2, "Up Time: %s",
+            Format::ElapsedTime(system.UpTime(), time, sizeof(time)));
+  wrefresh(window);
+}
+
+// Show the throughput of up to rows network interfaces
+void NCursesDisplay::DisplayNetwork(Network& network, WINDOW* window,
+                                    int rows) {
+  int row{0};
+  int const name_column{2};
+  int const rx_column{14};
+  int const tx_column{25};
+  int const rx_packets_column{36};
+  int const tx_packets_column{47};
+  int const rx_drop_column{58};
+  int const tx_drop_column{69};
+  network.Update();
+  werase(window);
+  box(window, 0, 0);
+  wattron(window, COLOR_PAIR(2));
+  mvwprintw(window, ++row, name_column, "IFACE");
+  mvwprintw(window, row, rx_column, "RX[KB/s]");
+  mvwprintw(window, row, tx_column, "TX[KB/s]");
+  mvwprintw(window, row, rx_packets_column, "RX[pkt/s]");
+  mvwprintw(window, row, tx_packets_column, "TX[pkt/s]");
+  mvwprintw(window, row, rx_drop_column, "RX[drop/s]");
+  mvwprintw(window, row, tx_drop_column, "TX[drop/s]");
+  wattroff(window, COLOR_PAIR(2));
+  for (auto& interface : network.Interfaces()) {
+    if (row > rows) {
+      break;
+    }
+    mvwprintw(window, ++row, name_column, "%.11s", interface.counters.name);
+    mvwprintw(window, row, rx_column, "%.1f", interface.rx_bytes_rate / 1024);
+    mvwprintw(window, row, tx_column, "%.1f", interface.tx_bytes_rate / 1024);
+    mvwprintw(window, row, rx_packets_column, "%.0f",
+              interface.rx_packets_rate);
+    mvwprintw(window, row, tx_packets_column, "%.0f",
+              interface.tx_packets_rate);
+    mvwprintw(window, row, rx_drop_column, "%.0f", interface.rx_drop_rate);
+    mvwprintw(window, row, tx_drop_column, "%.0f", interface.tx_drop_rate);
+  }
+  wrefresh(window);
+}
+
+// Show the throughput, IOPS, latency and utilization of up to rows disks,
+// with the history of their utilization
+void NCursesDisplay::DisplayDisks(Storage& storage, WINDOW* window, int rows) {
+  int row{0};
+  int const name_column{2};
+  int const read_column{12};
+  int const write_column{24};
+  int const iops_column{37};
+  int const await_column{45};
+  int const utilization_column{56};
+  int const history_column{65};
+  int history_width = std::clamp(getmaxx(window) - history_column - 1, 0,
+                                 static_cast<int>(History::kSize));
+  storage.Update();
+  werase(window);
+  box(window, 0, 0);
+  wattron(window, COLOR_PAIR(2));
+  mvwprintw(window, ++row, name_column, "DEVICE");
+  mvwprintw(window, row, read_column, "READ[KB/s]");
+  mvwprintw(window, row, write_column, "WRITE[KB/s]");
+  mvwprintw(window, row, iops_column, "IOPS");
+  mvwprintw(window, row, await_column, "AWAIT[ms]");
+  mvwprintw(window, row, utilization_column, "UTIL[%%]");
+  if (history_width > 0) {
+    mvwprintw(window, row, history_column, "%.*s", history_width,
+              "UTIL HISTORY");
+  }
+  wattroff(window, COLOR_PAIR(2));
+  for (auto& disk : storage.Disks()) {
+    if (row > rows) {
+      break;
+    }
+    mvwprintw(window, ++row, name_column, "%.9s", disk.counters.name);
+    mvwprintw(window, row, read_column, "%.1f", disk.read_rate / 1024);
+    mvwprintw(window, row, write_column, "%.1f", disk.write_rate / 1024);
+    mvwprintw(window, row, iops_column, "%.0f", disk.iops);
+    mvwprintw(window, row, await_column, "%.1f", disk.await);
+    mvwprintw(window, row, utilization_column, "%.1f",
+              disk.utilization * 100);
+    wattron(window, COLOR_PAIR(1));
+    wmove(window, row, history_column);
+    Sparkline(disk.utilization_history, 1.0, history_width, window);
+    wattroff(window, COLOR_PAIR(1));
+  }
   wrefresh(window);
 }
 
-void NCursesDisplay::DisplayProcesses(std::vector<Process>& processes,
-                                      WINDOW* window, int n) {
+// Print the threads of an expanded process below its row, followed by a
+// summary of how the threads are spread over cores and NUMA nodes
+// Returns the row of the last line printed
+int NCursesDisplay::DisplayThreads(Process& process, WINDOW* window, int row,
+                                   int last_row) {
+  int const tid_column{3};
+  int const state_column{11};
+  int const cpu_column{16};
+  int const processor_column{26};
+  char cpu[32];
+  if (process.Expanded()) {
+    for (auto& thread : process.Threads()) {
+      if (row >= last_row - 1) {
+        break;
+      }
+      mvwprintw(window, ++row, tid_column, "%d", thread.Tid());
+      mvwaddch(window, row, state_column, thread.State());
+      snprintf(cpu, sizeof(cpu), "%f", thread.CpuUtilization() * 100);
+      mvwprintw(window, row, cpu_column, "%.4s", cpu);
+      mvwprintw(window, row, processor_column, "cpu %d", thread.Processor());
+    }
+  }
+  if (row < last_row) {
+    wattron(window, A_DIM);
+    mvwprintw(window, ++row, tid_column, "%zu threads on %d cores, nodes:",
+              process.Threads().size(), process.CoresUsed());
+    auto& nodes = process.NodeThreads();
+    for (size_t node = 0; node < nodes.size(); ++node) {
+      wprintw(window, " %zu:%d", node, nodes[node]);
+    }
+    wattroff(window, A_DIM);
+  }
+  return row;
+}
+
+// With a network, a SOCK column shows the TCP sockets of every process
+// Returns the number of processes drawn, which is less than n when
+// expanded threads take some of the rows
+int NCursesDisplay::DisplayProcesses(std::vector<Process>& processes,
+                                      WINDOW* window, int n, int selected_pid,
+                                      Network* network) {
   int row{0};
   int const pid_column{2};
   int const user_column{9};
   int const cpu_column{16};
   int const ram_column{26};
   int const time_column{35};
-  int const command_column{46};
+  int const sockets_column{46};
+  int const command_column{network != nullptr ? 52 : 46};
+  int const last_row{n + 1};
+  char cpu[32];
+  char time[32];
   wattron(window, COLOR_PAIR(2));
   mvwprintw(window, ++row, pid_column, "PID");
   mvwprintw(window, row, user_column, "USER");
   mvwprintw(window, row, cpu_column, "CPU[%%]");
   mvwprintw(window, row, ram_column, "RAM[MB]");
   mvwprintw(window, row, time_column, "TIME+");
+  if (network != nullptr) {
+    mvwprintw(window, row, sockets_column, "SOCK");
+  }
   mvwprintw(window, row, command_column, "COMMAND");
   wattroff(window, COLOR_PAIR(2));
-  for (int i = 0; i < n; ++i) {
-    mvwprintw(window, ++row, pid_column, to_string(processes[i].Pid()).c_str());
-    mvwprintw(window, row, user_column, processes[i].User().c_str());
-    float cpu = processes[i].CpuUtilization() * 100;
-    mvwprintw(window, row, cpu_column, to_string(cpu).substr(0, 4).c_str());
-    mvwprintw(window, row, ram_column, processes[i].Ram().c_str());
-    mvwprintw(window, row, time_column,
-              Format::ElapsedTime(processes[i].UpTime()).c_str());
-    mvwprintw(window, row, command_column,
-              processes[i].Command().substr(0, window->_maxx - 46).c_str());
+  size_t i{0};
+  for (; i < processes.size() && processes[i].Visible() && row < last_row;
+       ++i) {
+    std::string_view user = processes[i].User();
+    std::string_view command = processes[i].Command();
+    int command_width = std::max(window->_maxx - command_column, 0);
+    mvwprintw(window, ++row, pid_column, "%d", processes[i].Pid());
+    mvwaddnstr(window, row, user_column, user.data(), user.size());
+    snprintf(cpu, sizeof(cpu), "%f", processes[i].CpuUtilization() * 100);
+    mvwprintw(window, row, cpu_column, "%.4s", cpu);
+    mvwprintw(window, row, ram_column, "%ld", processes[i].Ram());
+    mvwprintw(window, row, time_column, "%s",
+              Format::ElapsedTime(processes[i].UpTime(), time, sizeof(time)));
+    if (network != nullptr) {
+      mvwprintw(window, row, sockets_column, "%d",
+                processes[i].TcpSockets(*network));
+    }
+    mvwaddnstr(window, row, command_column, command.data(),
+               std::min<int>(command.size(), command_width));
+    if (processes[i].Pid() == selected_pid) {
+      mvwchgat(window, row, 1, window->_maxx - 1, A_REVERSE, 0, nullptr);
+    }
+    if (!processes[i].Threads().empty()) {
+      row = DisplayThreads(processes[i], window, row, last_row);
+    }
+  }
+  return i;
+}
+
+// Clear and draw the process window, with the active filter in the top
+// border and the footer (the monitor's own cost) in the bottom border
+// Returns the number of processes drawn
+int NCursesDisplay::DisplayProcessWindow(System& system,
+                                          std::vector<Process>& processes,
+                                          WINDOW* window, int n,
+                                          int selected_pid,
+                                          char const* footer) {
+  werase(window);
+  box(window, 0, 0);
+  if (!system.ProcessFilter().Empty()) {
+    mvwprintw(window, 0, 2, " filter: %s ",
+              system.ProcessFilter().Expression().c_str());
+  }
+  if (footer[0] != '\0') {
+    mvwprintw(window, getmaxy(window) - 1, 2, " %.*s ", getmaxx(window) - 6,
+              footer);
+  }
+  return DisplayProcesses(processes, window, n, selected_pid,
+                          system.Sockets() ? &system.Net() : nullptr);
+}
+
+// Read a filter expression on the bottom line of the process window
+// An invalid expression keeps the current filter and beeps
+void NCursesDisplay::PromptFilter(System& system, WINDOW* window) {
+  char expression[256];
+  int row{getmaxy(window) - 1};
+  wmove(window, row, 1);
+  wclrtoeol(window);
+  mvwprintw(window, row, 2, "filter: ");
+  echo();
+  wtimeout(window, -1);
+  wgetnstr(window, expression, sizeof(expression) - 1);
+  noecho();
+  if (!system.setFilter(expression)) {
+    beep();
+  }
+}
+
+// Move the selection with the arrow keys (or j/k) and expand or collapse
+// the threads of the selected process with t or enter
+// (/ to filter, i to toggle the cost footer and s to toggle socket counts
+// are handled by Display)
+// Only the processes that were drawn can be selected, so the selection
+// never moves to a row that expanded threads pushed off the table
+// Returns false when the user asked to quit
+bool NCursesDisplay::HandleKey(int key, std::vector<Process>& processes,
+                               int& selected_pid, int drawn) {
+  int selected{0};
+  for (size_t i = 0; i < processes.size(); ++i) {
+    if (processes[i].Pid() == selected_pid) {
+      selected = i;
+    }
+  }
+  int last = drawn - 1;
+  switch (key) {
+    case KEY_UP:
+    case 'k':
+      selected = std::max(std::min(selected, last + 1) - 1, 0);
+      break;
+    case KEY_DOWN:
+    case 'j':
+      selected = std::min(selected + 1, last);
+      break;
+    case 't':
+    case '\n':
+    case KEY_ENTER:
+      if (selected <= last) {
+        processes[selected].setExpanded(!processes[selected].Expanded());
+      }
+      break;
+    case 'q':
+      return false;
+  }
+  if (selected <= last) {
+    selected_pid = processes[selected].Pid();
+  }
+  return true;
+}
+
+// Return how many of its wanted rows a panel (with its header and border)
+// gets out of free_rows, and take them; 0 when not even one row fits, in
+// which case the panel is not shown
+int NCursesDisplay::PanelRows(int wanted, int& free_rows) {
+  int rows = std::min(wanted, free_rows - 3);
+  if (rows < 1) {
+    return 0;
   }
+  free_rows -= 3 + rows;
+  return rows;
+}
+
+/*  Create the windows for the current size of the terminal.
+
+    The process table gets its n rows first, as far as the terminal is
+    high enough and never fewer than kMinProcessRows, then the network and
+    disk panels share the rows that are left, one row per interface or
+    disk and up to 6 each.
+*/
+NCursesDisplay::Layout NCursesDisplay::CreateLayout(System& system, int n) {
+  int const system_height{10};
+  int lines{getmaxy(stdscr)};
+  int x_max{getmaxx(stdscr)};
+  Layout layout;
+  layout.process_rows =
+      std::max(std::min(n, lines - system_height - 3), kMinProcessRows);
+  int free_rows{lines - system_height - 3 - layout.process_rows};
+  layout.network_rows = PanelRows(
+      std::clamp(static_cast<int>(system.Net().Interfaces().size()), 1, 6),
+      free_rows);
+  layout.disk_rows = PanelRows(
+      std::clamp(static_cast<int>(system.Disks().Disks().size()), 1, 6),
+      free_rows);
+
+  int y{0};
+  layout.system = newwin(system_height, x_max - 1, y, 0);
+  y += system_height;
+  if (layout.network_rows > 0) {
+    layout.network = newwin(3 + layout.network_rows, x_max - 1, y, 0);
+    y += 3 + layout.network_rows;
+  }
+  if (layout.disk_rows > 0) {
+    layout.disks = newwin(3 + layout.disk_rows, x_max - 1, y, 0);
+    y += 3 + layout.disk_rows;
+  }
+  layout.processes = newwin(3 + layout.process_rows, x_max - 1, y, 0);
+  keypad(layout.processes, TRUE);
+  return layout;
+}
+
+// Delete the windows of a layout, before the terminal is resized or
+// ncurses ends
+void NCursesDisplay::DeleteLayout(Layout& layout) {
+  for (WINDOW* window :
+       {layout.system, layout.network, layout.disks, layout.processes}) {
+    if (window != nullptr) {
+      delwin(window);
+    }
+  }
+  layout = Layout{};
 }
 
 void NCursesDisplay::Display(System& system, int n) {
@@ -88,22 +406,88 @@ void NCursesDisplay::Display(System& system, int n) {
   cbreak();       // terminate ncurses on ctrl + c
   start_color();  // enable color
 
-  int x_max{getmaxx(stdscr)};
-  WINDOW* system_window = newwin(9, x_max - 1, 0, 0);
-  WINDOW* process_window =
-      newwin(3 + n, x_max - 1, system_window->_maxy + 1, 0);
+  // the number of interfaces and disks sizes their panels
+  system.Net().Update();
+  system.Disks().Update();
+  Layout layout = CreateLayout(system, n);
 
-  while (1) {
+  int selected_pid{-1};
+  int drawn{0};
+  bool running{true};
+  bool show_costs{false};
+  char costs[256]{};
+  Instrument::Totals last_totals = Instrument::Collect();
+  while (running) {
     init_pair(1, COLOR_BLUE, COLOR_BLACK);
     init_pair(2, COLOR_GREEN, COLOR_BLACK);
-    box(system_window, 0, 0);
-    box(process_window, 0, 0);
-    DisplaySystem(system, system_window);
-    DisplayProcesses(system.Processes(), process_window, n);
-    wrefresh(system_window);
-    wrefresh(process_window);
-    refresh();
-    std::this_thread::sleep_for(std::chrono::seconds(1));
+    box(layout.system, 0, 0);
+    {
+      Instrument::ScopedTimer timer(Instrument::kSystem);
+      DisplaySystem(system, layout.system);
+      if (layout.network != nullptr) {
+        DisplayNetwork(system.Net(), layout.network, layout.network_rows);
+      }
+      if (layout.disks != nullptr) {
+        DisplayDisks(system.Disks(), layout.disks, layout.disk_rows);
+      }
+    }
+    std::vector<Process>& processes = system.Processes();
+    if (selected_pid < 0 && !processes.empty()) {
+      selected_pid = processes[0].Pid();
+    }
+    {
+      Instrument::ScopedTimer timer(Instrument::kDraw);
+      drawn = DisplayProcessWindow(system, processes, layout.processes,
+                                   layout.process_rows, selected_pid,
+                                   show_costs ? costs : "");
+      wrefresh(layout.system);
+      wrefresh(layout.processes);
+      refresh();
+    }
+
+    // cost of this tick, shown in the footer during the next one
+    Instrument::Totals totals = Instrument::Collect();
+    Instrument::Summary(totals - last_totals, costs, sizeof(costs));
+    last_totals = totals;
+
+    // handle key presses until the next tick, redrawing from the last sample
+    auto next_tick = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+    while (running) {
+      auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+          next_tick - std::chrono::steady_clock::now());
+      if (remaining.count() <= 0) {
+        break;
+      }
+      wtimeout(layout.processes, remaining.count());
+      int key = wgetch(layout.processes);
+      if (key == ERR) {
+        continue;
+      }
+      if (key == KEY_RESIZE) {
+        DeleteLayout(layout);
+        clear();
+        refresh();
+        layout = CreateLayout(system, n);
+        break;
+      }
+      if (key == '/') {
+        PromptFilter(system, layout.processes);
+        break;
+      }
+      if (key == 'i') {
+        show_costs = !show_costs;
+      }
+      if (key == 's') {
+        system.setSockets(!system.Sockets());
+        break;
+      }
+      running = HandleKey(key, processes, selected_pid, drawn);
+      drawn = DisplayProcessWindow(system, processes, layout.processes,
+                                   layout.process_rows, selected_pid,
+                                   show_costs ? costs : "");
+      wrefresh(layout.processes);
+    }
   }
+  DeleteLayout(layout);
   endwin();
-}
\ No newline at end of file
+}
@@ -0,0 +1,85 @@
+#include <algorithm>
+#include <utility>
+
+#include "network.h"
+
+// Re-read /proc/net/dev and calculate the rate of every counter
+void Network::Update() {
+  float seconds = interval_.Seconds();
+  LinuxParser::NetDevices(read_);
+  // interfaces rarely come and go; rebuild the list when they do
+  bool same = Rates::SameNames(read_, devices_);
+  std::swap(read_, devices_);
+  if (!same) {
+    interfaces_.assign(devices_.size(), Interface{});
+    for (size_t i = 0; i < devices_.size(); ++i) {
+      interfaces_[i].counters = devices_[i];
+    }
+    return;
+  }
+
+  for (size_t i = 0; i < devices_.size(); ++i) {
+    auto const& current = devices_[i];
+    auto const& previous = read_[i];
+    Interface& interface = interfaces_[i];
+    interface.counters = current;
+    interface.rx_bytes_rate =
+        Rates::Rate(current.rx_bytes, previous.rx_bytes, seconds);
+    interface.tx_bytes_rate =
+        Rates::Rate(current.tx_bytes, previous.tx_bytes, seconds);
+    interface.rx_packets_rate =
+        Rates::Rate(current.rx_packets, previous.rx_packets, seconds);
+    interface.tx_packets_rate =
+        Rates::Rate(current.tx_packets, previous.tx_packets, seconds);
+    interface.rx_drop_rate =
+        Rates::Rate(current.rx_drop, previous.rx_drop, seconds);
+    interface.tx_drop_rate =
+        Rates::Rate(current.tx_drop, previous.tx_drop, seconds);
+  }
+}
+
+// Return the interfaces as of the last Update()
+std::vector<Network::Interface>& Network::Interfaces() { return interfaces_; }
+
+// Rebuild the set of TCP socket inodes, once per tick, so that counting
+// the sockets of a process is a lookup per fd instead of a scan of
+// /proc/net/tcp per process
+void Network::UpdateSockets() {
+  LinuxParser::TcpInodes(inodes_);
+  size_t size{64};
+  while (size < 2 * inodes_.size()) {
+    size *= 2;
+  }
+  tcp_inodes_.assign(size, 0);
+  for (unsigned long inode : inodes_) {
+    size_t slot = inode & (size - 1);
+    while (tcp_inodes_[slot] != 0 && tcp_inodes_[slot] != inode) {
+      slot = (slot + 1) & (size - 1);
+    }
+    tcp_inodes_[slot] = inode;
+  }
+}
+
+// Return whether an inode is one of the TCP sockets of the last
+// UpdateSockets()
+bool Network::IsTcpSocket(unsigned long inode) const {
+  if (tcp_inodes_.empty()) {
+    return false;
+  }
+  size_t mask = tcp_inodes_.size() - 1;
+  for (size_t slot = inode & mask; tcp_inodes_[slot] != 0;
+       slot = (slot + 1) & mask) {
+    if (tcp_inodes_[slot] == inode) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Return the number of TCP sockets (IPv4 and IPv6) a process has open
+int Network::TcpSockets(int pid) {
+  LinuxParser::SocketInodes(pid, inodes_);
+  return std::count_if(
+      inodes_.begin(), inodes_.end(),
+      [this](unsigned long inode) { return IsTcpSocket(inode); });
+}
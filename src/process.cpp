@@ -1,15 +1,27 @@
 #include <unistd.h>
+#include <algorithm>
 #include <cctype>
-#include <sstream>
+#include <cstring>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include "instrument.h"
 #include "process.h"
 
 using std::string;
-using std::to_string;
+using std::string_view;
 using std::vector;
 
+// maximum number of characters kept of a command line
+size_t Process::command_length_{256};
+
+// user names and command lines of all processes
+StringTable Process::strings_;
+
+// interned user name of every uid seen so far
+std::unordered_map<long, StringTable::Handle> Process::users_;
+
 // set this processes' ID
 void Process::setPid(int pid) {
     pid_ = pid;
@@ -18,49 +30,261 @@ void Process::setPid(int pid) {
 // Return this process's ID
 int Process::Pid() { return pid_; }
 
-// Return this process's CPU utilization
-// Calculated since the last time this function was called
-float Process::CpuUtilization() { 
-    long current_active;
-    long current_uptime;
-    long d_active;
-    long d_uptime;
+// Return the ID of this process's parent as of the last Update()
+int Process::Ppid() { return ppid_; }
+
+// Return this process's state (R, S, D, ...) as of the last Update()
+char Process::State() { return state_; }
+
+// Return whether this process passed the filter on the last tick
+bool Process::Visible() { return visible_; }
+
+void Process::setVisible(bool visible) { visible_ = visible; }
+
+// Return this process's CPU utilization as of the last Update()
+float Process::CpuUtilization() { return cpu_utilization_; }
 
-    current_active = LinuxParser::ActiveJiffies(pid_);
-    current_uptime = LinuxParser::UpTime(pid_);
+// Forget the status and socket count read during the last tick, so that
+// they are read again (at most once) when next asked for
+void Process::Expire() {
+    status_read_ = false;
+    sockets_read_ = false;
+}
+
+// Re-read this process's stat file
+// Utilization is calculated since the last time this function was called,
+// against the system uptime (in seconds) passed in by the caller
+void Process::Update(long uptime) {
+    LinuxParser::Stat stat;
+    if (!LinuxParser::ParseStat(pid_, stat)) {
+        return;
+    }
+    // a new starttime means the PID was reused by a different process
+    if (stat.starttime != starttime_) {
+        starttime_ = stat.starttime;
+        ReleaseStrings();
+    }
+    ppid_ = stat.ppid;
+    state_ = stat.state;
+    memcpy(name_, stat.name, sizeof(name_));
+    long current_active = stat.utime + stat.stime + stat.cutime + stat.cstime;
+    long current_uptime = uptime - stat.starttime / sysconf(_SC_CLK_TCK);
 
     // difference in active jiffies
-    d_active = current_active - prev_active_;
+    long d_active = current_active - prev_active_;
 
     // difference in time
-    d_uptime = current_uptime - prev_uptime_;
+    long d_uptime = current_uptime - prev_uptime_;
 
     // update
     prev_active_ = current_active;
     prev_uptime_ = current_uptime;
+    uptime_ = current_uptime;
 
     if (d_uptime != 0) {
         cpu_utilization_ = (static_cast<float>(d_active) / sysconf(_SC_CLK_TCK))
                          / static_cast<float>(d_uptime);
     }
-    
-    return cpu_utilization_;
 }
 
 // Return the command that generated this process
-string Process::Command() { return LinuxParser::Command(pid_); }
+// The command line rarely changes after exec, so it is only read the first
+// time it is asked for (a rendered or filtered row) and then cached
+string_view Process::Command() {
+    if (!command_read_) {
+        static vector<char> buffer;
+        buffer.resize(command_length_);
+        size_t length = LinuxParser::Command(pid_, buffer.data(), buffer.size());
+        command_ = strings_.Intern(string_view(buffer.data(), length));
+        command_read_ = true;
+    }
+    return strings_.Get(command_);
+}
 
-// Return this process's memory utilization
-string Process::Ram() { return LinuxParser::Ram(pid_); }
+// Return the executable name (comm) as of the last Update(), at most 15
+// characters and without the arguments of the command line
+string_view Process::Name() { return name_; }
+
+// Release the command line when the process exits or its PID is reused
+void Process::ReleaseStrings() {
+    if (command_read_) {
+        strings_.Release(command_);
+        command_ = {};
+        command_read_ = false;
+    }
+}
+
+// Set the maximum number of characters kept of a command line
+void Process::setCommandLength(size_t length) { command_length_ = length; }
+
+/*  Reclaim the bytes of released command lines once they outweigh the
+    live ones, by interning every live string into a fresh table and
+    pointing the processes (and the user cache) at the new handles.
+*/
+void Process::CompactStrings(vector<Process>& processes) {
+    if (strings_.GarbageBytes() < StringTable::kBlockSize
+        || strings_.GarbageBytes() < strings_.LiveBytes()) {
+        return;
+    }
+    StringTable strings;
+    for (auto & user : users_) {
+        user.second = strings.Intern(strings_.Get(user.second));
+    }
+    for (auto & proc : processes) {
+        if (proc.command_read_) {
+            proc.command_ = strings.Intern(strings_.Get(proc.command_));
+        }
+    }
+    strings_ = std::move(strings);
+}
+
+// Read the uid and memory of this process, once per tick (see Expire)
+void Process::ReadStatus() {
+    if (status_read_) {
+        return;
+    }
+    LinuxParser::Status status;
+    if (LinuxParser::ParseStatus(pid_, status)) {
+        uid_ = status.uid;
+        ram_kb_ = status.vm_data;
+    }
+    status_read_ = true;
+}
+
+// Return this process's memory utilization in MB
+long Process::Ram() {
+    ReadStatus();
+    return ram_kb_ / 1000;
+}
+
+// Return this process's memory utilization in kB
+long Process::RamKb() {
+    ReadStatus();
+    return ram_kb_;
+}
+
+// Return the number of TCP sockets this process has open
+// Only counted for the rows that ask for it, once per tick
+int Process::TcpSockets(Network& network) {
+    if (!sockets_read_) {
+        tcp_sockets_ = network.TcpSockets(pid_);
+        sockets_read_ = true;
+    }
+    return tcp_sockets_;
+}
+
+// Return the ID of the user that owns this process
+long Process::Uid() {
+    ReadStatus();
+    return uid_;
+}
 
 // Return the user (name) that generated this process
-string Process::User() { return LinuxParser::User(pid_); }
+// /etc/passwd is only read the first time a uid is seen
+string_view Process::User() {
+    Instrument::ScopedTimer timer(Instrument::kUser);
+    long uid = Uid();
+    auto user = users_.find(uid);
+    if (user == users_.end()) {
+        string name = LinuxParser::UserName(uid);
+        if (name.empty()) {
+            name = std::to_string(uid);
+        }
+        user = users_.emplace(uid, strings_.Intern(name)).first;
+    }
+    return strings_.Get(user->second);
+}
 
 // Return the age of this process (in seconds)
-long int Process::UpTime() { return LinuxParser::UpTime(pid_); }
+long int Process::UpTime() { return uptime_; }
+
+// Return whether the user expanded this process into its threads
+bool Process::Expanded() { return expanded_; }
+
+void Process::setExpanded(bool expanded) { expanded_ = expanded; }
+
+/*  Walk /proc/[PID]/task and refresh this process's threads.
+
+    Threads that still exist keep their previous jiffies so their
+    utilization is a delta, new threads are appended and exited threads
+    are dropped. The threads are then summarized by the number of
+    distinct cores they last ran on and the number of threads per NUMA node.
+*/
+void Process::UpdateThreads(long uptime, vector<int> const& cpu_nodes) {
+    // scratch vectors, reused so that their capacity survives between ticks
+    static vector<int> tids;
+    static vector<Thread> threads;
+    static vector<bool> cores;
+
+    LinuxParser::Tids(pid_, tids);
+    std::sort(tids.begin(), tids.end());
+
+    // merge the sorted tids with the previous threads ordered by tid
+    std::sort(threads_.begin(), threads_.end(),
+              [](Thread const& a, Thread const& b) { return a.Tid() < b.Tid(); });
+    threads.clear();
+    auto old = threads_.begin();
+    for (int tid : tids) {
+        while (old != threads_.end() && old->Tid() < tid) {
+            ++old;
+        }
+        if (old != threads_.end() && old->Tid() == tid) {
+            threads.emplace_back(*old);
+        } else {
+            Thread thread;
+            thread.setTid(pid_, tid);
+            threads.emplace_back(thread);
+        }
+        threads.back().Update(uptime);
+    }
+    std::sort(threads.begin(), threads.end());
+    // copied rather than swapped, so that every process keeps its own
+    // capacity instead of passing it on to the next one
+    threads_.assign(threads.begin(), threads.end());
+
+    // placement summary
+    cores.assign(cpu_nodes.size(), false);
+    node_threads_.assign(1, 0);
+    cores_used_ = 0;
+    for (auto const& thread : threads_) {
+        int cpu = thread.Processor();
+        if (cpu < 0 || cpu >= static_cast<int>(cpu_nodes.size())) {
+            continue;
+        }
+        if (!cores[cpu]) {
+            cores[cpu] = true;
+            cores_used_++;
+        }
+        u_int node = cpu_nodes[cpu];
+        if (node >= node_threads_.size()) {
+            node_threads_.resize(node + 1, 0);
+        }
+        node_threads_[node]++;
+    }
+}
+
+// Drop the threads of a process that is no longer expanded or in the top-K
+void Process::ClearThreads() {
+    threads_.clear();
+    node_threads_.clear();
+    cores_used_ = 0;
+}
+
+// Return the threads collected by the last UpdateThreads()
+vector<Thread>& Process::Threads() { return threads_; }
+
+// Return the number of distinct cores the threads last ran on
+int Process::CoresUsed() { return cores_used_; }
+
+// Return the number of threads that last ran on each NUMA node
+vector<int>& Process::NodeThreads() { return node_threads_; }
 
 // Overload the "less than" comparison operator for Process objects
-// Compare by cpu utilization
+// Compare by cpu utilization, then by pid so that the order of idle
+// processes (and so the top-K whose threads are collected) is stable
 bool Process::operator<(Process const& a) const {
-return a.cpu_utilization_ < cpu_utilization_;
+if (a.cpu_utilization_ != cpu_utilization_) {
+    return a.cpu_utilization_ < cpu_utilization_;
+}
+return pid_ < a.pid_;
 }
\ No newline at end of file
@@ -2,7 +2,8 @@
 #include <string>
 
 // Return the aggregate CPU utilization
-// Calculated since the last time this function was called
+// Calculated since the last time this function was called, and recorded
+// in the utilization history
 float Processor::Utilization() 
 { 
     float utilization;
@@ -26,7 +27,11 @@ float Processor::Utilization()
     
     utilization = static_cast<float>(d_active)
                 / static_cast<float>(d_total);
+    history_.Add(utilization);
     
     return utilization;
 
-}
\ No newline at end of file
+}
+
+// Return the utilizations of the last History::kSize calls of Utilization()
+History const& Processor::UtilizationHistory() const { return history_; }
\ No newline at end of file
@@ -0,0 +1,21 @@
+#include "rates.h"
+
+// Return how much a counter grew; a counter that went backwards was reset
+// (or wrapped) and counts as 0
+long Rates::Delta(long current, long previous) {
+  return current < previous ? 0 : current - previous;
+}
+
+// Return how much a counter grew per second
+float Rates::Rate(long current, long previous, float seconds) {
+  return Delta(current, previous) / seconds;
+}
+
+// Return the seconds since the last call, or since the epoch of the
+// steady clock on the first one
+float Rates::Interval::Seconds() {
+  auto now = std::chrono::steady_clock::now();
+  float seconds = std::chrono::duration<float>(now - last_).count();
+  last_ = now;
+  return seconds;
+}
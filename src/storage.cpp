@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <utility>
+
+#include "storage.h"
+
+// Re-read /proc/diskstats and calculate the rates of every disk
+void Storage::Update() {
+  float seconds = interval_.Seconds();
+  LinuxParser::DiskStats(read_);
+  // devices rarely come and go; rebuild the list when they do
+  bool same = Rates::SameNames(read_, stats_);
+  std::swap(read_, stats_);
+  if (!same) {
+    Rebuild();
+    return;
+  }
+
+  for (auto& disk : disks_) {
+    auto const& current = stats_[disk.index];
+    auto const& previous = read_[disk.index];
+    long ios = Rates::Delta(current.reads, previous.reads) +
+               Rates::Delta(current.writes, previous.writes);
+    long time = Rates::Delta(current.read_time, previous.read_time) +
+                Rates::Delta(current.write_time, previous.write_time);
+    disk.counters = current;
+    disk.read_rate =
+        Rates::Rate(current.read_sectors, previous.read_sectors, seconds) *
+        512;
+    disk.write_rate =
+        Rates::Rate(current.write_sectors, previous.write_sectors, seconds) *
+        512;
+    disk.iops = ios / seconds;
+    disk.await = ios > 0 ? static_cast<float>(time) / ios : 0;
+    disk.utilization = std::min(
+        Rates::Rate(current.io_time, previous.io_time, seconds) / 1000, 1.0f);
+    disk.utilization_history.Add(disk.utilization);
+  }
+}
+
+// Keep the disks (and partitions if enabled) of the last read, starting
+// their rates and histories over
+void Storage::Rebuild() {
+  disks_.clear();
+  for (size_t i = 0; i < stats_.size(); ++i) {
+    auto kind = LinuxParser::DiskKind(stats_[i].name);
+    if (kind == LinuxParser::kDisk_ ||
+        (partitions_ && kind == LinuxParser::kPartition_)) {
+      Disk disk;
+      disk.counters = stats_[i];
+      disk.index = i;
+      disks_.push_back(disk);
+    }
+  }
+}
+
+// Return the disks as of the last Update()
+std::vector<Storage::Disk>& Storage::Disks() { return disks_; }
+
+// Show partitions as well as whole disks, from the next Update() on
+void Storage::setPartitions(bool partitions) {
+  partitions_ = partitions;
+  stats_.clear();
+}
@@ -0,0 +1,60 @@
+#include <algorithm>
+#include <cstring>
+
+#include "string_table.h"
+
+// Return the handle of a string, copying it into the arena the first time
+// it is seen. Every call must be balanced by a Release().
+StringTable::Handle StringTable::Intern(std::string_view text) {
+  if (text.empty()) {
+    return Handle{};
+  }
+  auto entry = entries_.find(text);
+  if (entry != entries_.end()) {
+    entry->second.references++;
+    return entry->second.handle;
+  }
+
+  // bump allocate, strings longer than a block get a block of their own
+  if (used_ + text.size() > kBlockSize) {
+    blocks_.emplace_back(new char[std::max(text.size(), kBlockSize)]);
+    used_ = 0;
+  }
+  Handle handle;
+  handle.block = blocks_.size() - 1;
+  handle.offset = used_;
+  handle.length = text.size();
+  memcpy(blocks_.back().get() + used_, text.data(), text.size());
+  used_ += text.size();
+  live_ += text.size();
+
+  entries_.emplace(Get(handle), Entry{handle, 1});
+  return handle;
+}
+
+// Drop one reference to a string; its bytes become garbage with the last
+void StringTable::Release(Handle handle) {
+  if (handle.length == 0) {
+    return;
+  }
+  auto entry = entries_.find(Get(handle));
+  if (entry != entries_.end() && --entry->second.references == 0) {
+    entries_.erase(entry);
+    live_ -= handle.length;
+    garbage_ += handle.length;
+  }
+}
+
+// Return the characters of an interned string
+std::string_view StringTable::Get(Handle handle) const {
+  if (handle.length == 0) {
+    return {};
+  }
+  return {blocks_[handle.block].get() + handle.offset, handle.length};
+}
+
+// Return the number of bytes held by referenced strings
+size_t StringTable::LiveBytes() const { return live_; }
+
+// Return the number of bytes held by released strings
+size_t StringTable::GarbageBytes() const { return garbage_; }
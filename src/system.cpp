@@ -8,6 +8,7 @@
 
 //#include "process.h"
 //#include "processor.h"
+#include "instrument.h"
 #include "system.h"
 
 using namespace std;
@@ -15,6 +16,12 @@ using namespace std;
 // Return the system's CPU
 Processor& System::Cpu() { return cpu_; }
 
+// Return the system's network interfaces and sockets
+Network& System::Net() { return network_; }
+
+// Return the system's block devices
+Storage& System::Disks() { return storage_; }
+
 /*  Return a container composed of the system's processes.
 
     On each call of this function, the vector of Process objects
@@ -24,56 +31,125 @@ Processor& System::Cpu() { return cpu_; }
 */
 vector<Process>& System::Processes() { 
     
-    // fill an int vector of old pids from the last call
-    std::vector<int> old_pids;
-    for (auto & proc : processes_) {
-        old_pids.emplace_back(proc.Pid());
-    }
-    // vector of new pids
-    std::vector<int> new_pids = LinuxParser::Pids();
+    {
+        Instrument::ScopedTimer timer(Instrument::kPids);
+        // the pid vectors are members, so their capacity is reused
+        // fill an int vector of old pids from the last call
+        old_pids_.clear();
+        for (auto & proc : processes_) {
+            old_pids_.emplace_back(proc.Pid());
+        }
+        // vector of new pids
+        LinuxParser::Pids(new_pids_);
 
-    // sort these vectors
-    std::sort(old_pids.begin(), old_pids.end());
-    std::sort(new_pids.begin(), new_pids.end());
+        // sort these vectors
+        std::sort(old_pids_.begin(), old_pids_.end());
+        std::sort(new_pids_.begin(), new_pids_.end());
 
-    // their difference: deleted and added pids
-    std::vector<int> deleted_pids;
-    std::vector<int> added_pids;
+        // their difference: deleted and added pids
+        deleted_pids_.clear();
+        added_pids_.clear();
 
-    // added pids
-    std::set_difference(new_pids.begin(), new_pids.end(), 
-                        old_pids.begin(), old_pids.end(), 
-                        std::inserter(added_pids, added_pids.begin()));
+        // added pids
+        std::set_difference(new_pids_.begin(), new_pids_.end(), 
+                            old_pids_.begin(), old_pids_.end(), 
+                            std::back_inserter(added_pids_));
     
-    // killed pids
-    std::set_difference(old_pids.begin(), old_pids.end(), 
-                        new_pids.begin(), new_pids.end(), 
-                        std::inserter(deleted_pids, deleted_pids.begin()));
-
-    // add newly started processes to processes_ vector
-    for (int pid : added_pids) {
-        Process proc;
-        proc.setPid(pid);
-        processes_.emplace_back(proc);
+        // killed pids
+        std::set_difference(old_pids_.begin(), old_pids_.end(), 
+                            new_pids_.begin(), new_pids_.end(), 
+                            std::back_inserter(deleted_pids_));
+
+        // add newly started processes to processes_ vector
+        for (int pid : added_pids_) {
+            Process proc;
+            proc.setPid(pid);
+            processes_.emplace_back(proc);
+        }
+        // erase newly killed processes from the processes_ vector,
+        // releasing their strings
+        auto killed = [this](Process & proc) {
+            if (!std::binary_search(deleted_pids_.begin(), deleted_pids_.end(),
+                                    proc.Pid())) {
+                return false;
+            }
+            proc.ReleaseStrings();
+            return true;
+        };
+        processes_.erase(std::remove_if(processes_.begin(), processes_.end(),
+                                        killed),
+                         processes_.end());
+        Process::CompactStrings(processes_);
     }
-    // erase newly killed processes from the processes_ vector
-    for (u_int i = 0; i < processes_.size(); i++) {
-        for (int pid : deleted_pids) {
-            if (processes_[i].Pid() == pid) {
-                processes_.erase(processes_.begin() + i);
+
+    // sample every process against the same system uptime
+    // The filter is applied stage by stage, so a process rejected on its
+    // status fields (uid, user, ram) never has its stat file read, and one
+    // rejected on its stat fields never has its cmdline read
+    long uptime = LinuxParser::UpTime();
+    {
+        Instrument::ScopedTimer timer(Instrument::kParse);
+        // one inode table per tick, for the socket counts of the drawn rows
+        if (sockets_) {
+            network_.UpdateSockets();
+        }
+        for (auto & proc : processes_) {
+            proc.Expire();
+            bool visible = filter_.Matches(proc, Filter::kIdentity)
+                        && filter_.Matches(proc, Filter::kStatus);
+            if (visible) {
+                proc.Update(uptime);
+                visible = filter_.Matches(proc, Filter::kStat)
+                       && filter_.Matches(proc, Filter::kDetail);
             }
+            proc.setVisible(visible);
         }
     }
-    // Sort list of processes
-    std::sort(processes_.begin(), processes_.end(),
-                [](const auto & p1, const auto & p2) {return p1 < p2; });
-    
+
+    // Sort list of processes, visible ones first
+    {
+        Instrument::ScopedTimer timer(Instrument::kSort);
+        std::sort(processes_.begin(), processes_.end(),
+                    [](auto & p1, auto & p2) {
+                        if (p1.Visible() != p2.Visible()) { return p1.Visible(); }
+                        return p1 < p2; });
+    }
+
+    // only walk /proc/[PID]/task for expanded processes and the top-K
+    Instrument::ScopedTimer timer(Instrument::kParse);
+    for (u_int i = 0; i < processes_.size(); i++) {
+        if (processes_[i].Visible() && (processes_[i].Expanded()
+                || static_cast<int>(i) < thread_top_k_)) {
+            processes_[i].UpdateThreads(uptime, cpu_nodes_);
+        } else if (!processes_[i].Threads().empty()) {
+            processes_[i].ClearThreads();
+        }
+    }
+
     return processes_;
 }
 
-// Return the system's kernel identifier (string)
-std::string System::Kernel() { 
-    return LinuxParser::Kernel();
+// Compile and set the process filter, see include/filter.h for the syntax
+// Returns false and keeps the current filter if the expression is invalid
+bool System::setFilter(std::string const& expression) {
+    return filter_.Compile(expression);
+}
+
+// Return the current process filter
+Filter const& System::ProcessFilter() { return filter_; }
+
+// Enable counting the TCP sockets of every drawn process
+void System::setSockets(bool sockets) { sockets_ = sockets; }
+
+// Return whether TCP sockets are counted
+bool System::Sockets() { return sockets_; }
+
+// Set how many of the busiest processes have their threads collected
+void System::setThreadTopK(int k) { thread_top_k_ = k; }
+
+// Return the system's kernel identifier (string), read once
+std::string const& System::Kernel() { 
+    return kernel_;
 }
 
 // Return the system's memory utilization
@@ -81,9 +157,9 @@ float System::MemoryUtilization() {
     return LinuxParser::MemoryUtilization();
 }
 
-// Return the operating system name
-std::string System::OperatingSystem() { 
-    return LinuxParser::OperatingSystem(); 
+// Return the operating system name, read once
+std::string const& System::OperatingSystem() { 
+    return operating_system_;
 }
 
 // Return the number of processes actively running on the system
@@ -0,0 +1,51 @@
+#include <unistd.h>
+
+#include "thread.h"
+
+// set the owning process ID and this thread's ID
+void Thread::setTid(int pid, int tid) {
+  pid_ = pid;
+  tid_ = tid;
+}
+
+// Return this thread's ID
+int Thread::Tid() const { return tid_; }
+
+// Return this thread's state (R, S, D, ...)
+char Thread::State() const { return state_; }
+
+// Return the CPU this thread last ran on
+int Thread::Processor() const { return processor_; }
+
+// Return this thread's CPU utilization as of the last Update()
+float Thread::CpuUtilization() const { return cpu_utilization_; }
+
+// Re-read this thread's stat file
+// Utilization is calculated since the last time this function was called,
+// against the system uptime (in seconds) passed in by the caller
+void Thread::Update(long uptime) {
+  LinuxParser::Stat stat;
+  if (!LinuxParser::ParseStat(pid_, tid_, stat)) {
+    return;
+  }
+  state_ = stat.state;
+  processor_ = stat.processor;
+
+  // threads have no children, so only utime and stime count
+  long current_active = stat.utime + stat.stime;
+  long d_active = current_active - prev_active_;
+  long d_uptime = uptime - prev_uptime_;
+
+  prev_active_ = current_active;
+  prev_uptime_ = uptime;
+
+  if (d_uptime != 0) {
+    cpu_utilization_ = (static_cast<float>(d_active) / sysconf(_SC_CLK_TCK)) /
+                       static_cast<float>(d_uptime);
+  }
+}
+
+// Compare by cpu utilization, busiest thread first
+bool Thread::operator<(Thread const& a) const {
+  return a.cpu_utilization_ < cpu_utilization_;
+}
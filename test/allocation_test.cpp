@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "instrument.h"
+#include "system.h"
+
+/*
+Checks that a steady state tick does not allocate
+
+A tick reads what the displays show: the system panel, the network and
+disk panels and the processes, with the user and command of the rows that
+would be drawn. Starting or exiting processes legitimately allocate, so
+only ticks that see the same PIDs as the tick before are checked. On a
+busy host ticks are repeated until kStableTicks of them were checked or
+kBudget has passed; if no tick at all was stable the test is skipped
+rather than failed.
+*/
+
+namespace {
+constexpr int kWarmupTicks{3};
+constexpr int kStableTicks{10};
+constexpr std::chrono::seconds kBudget{30};
+// ctest's SKIP_RETURN_CODE for this test
+constexpr int kSkipped{77};
+constexpr int kRows{15};
+
+void Tick(System& system) {
+  system.Cpu().Utilization();
+  system.MemoryUtilization();
+  system.TotalProcesses();
+  system.RunningProcesses();
+  system.Net().Update();
+  system.Disks().Update();
+  std::vector<Process>& processes = system.Processes();
+  for (int i = 0; i < kRows && i < static_cast<int>(processes.size()); ++i) {
+    processes[i].User();
+    processes[i].Command();
+    processes[i].Ram();
+  }
+}
+
+// The strings of a process are interned once per lifetime; read them all
+// so that a process moving into the drawn rows is not a new one
+void ReadStrings(System& system) {
+  for (auto& process : system.Processes()) {
+    process.User();
+    process.Command();
+  }
+}
+
+void Pids(System& system, std::vector<int>& pids) {
+  pids.clear();
+  for (auto& process : system.Processes()) {
+    pids.push_back(process.Pid());
+  }
+  std::sort(pids.begin(), pids.end());
+}
+}  // namespace
+
+int main() {
+  System system;
+  system.setThreadTopK(5);
+  for (int tick = 0; tick < kWarmupTicks; ++tick) {
+    Tick(system);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  ReadStrings(system);
+
+  std::vector<int> before;
+  std::vector<int> after;
+  before.reserve(4096);
+  after.reserve(4096);
+  int checked{0};
+  int failed{0};
+  int tick{0};
+  auto deadline = std::chrono::steady_clock::now() + kBudget;
+  for (; checked < kStableTicks && std::chrono::steady_clock::now() < deadline;
+       ++tick) {
+    Pids(system, before);
+    long allocations =
+        Instrument::Collect().counters[Instrument::kAllocations];
+    Tick(system);
+    allocations =
+        Instrument::Collect().counters[Instrument::kAllocations] - allocations;
+    Pids(system, after);
+    if (before != after) {
+      ReadStrings(system);
+      continue;
+    }
+    ++checked;
+    if (allocations != 0) {
+      ++failed;
+      printf("tick %d: %ld allocations\n", tick, allocations);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  printf("%d of %d ticks checked, %d allocated\n", checked, tick, failed);
+  if (checked == 0) {
+    printf("skipped: processes started or exited during every tick\n");
+    return kSkipped;
+  }
+  return failed == 0 ? 0 : 1;
+}